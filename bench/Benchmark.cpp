@@ -0,0 +1,62 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+using Micros = std::chrono::duration<double, std::micro>;
+
+// Nearest-rank percentile of an ascending, non-empty sample set.
+double percentileUs(const std::vector<std::chrono::steady_clock::duration>& sorted, double p) {
+    const auto rank = static_cast<std::size_t>(std::ceil(p * sorted.size()));
+    const std::size_t index = std::min(sorted.size() - 1, rank == 0 ? 0 : rank - 1);
+    return Micros(sorted[index]).count();
+}
+
+} // namespace
+
+QJsonObject BenchmarkResult::toJson() const {
+    return {
+        { "name", QString::fromStdString(name) },
+        { "operations", static_cast<qint64>(operations) },
+        { "failures", static_cast<qint64>(failures) },
+        { "opsPerSecond", opsPerSecond },
+        { "meanUs", meanUs },
+        { "p50Us", p50Us },
+        { "p99Us", p99Us },
+        { "p999Us", p999Us },
+    };
+}
+
+LatencySamples::LatencySamples(std::string name, std::size_t expected)
+    : name_(std::move(name)) {
+    samples_.reserve(expected);
+}
+
+void LatencySamples::merge(LatencySamples&& other) {
+    samples_.insert(samples_.end(), other.samples_.begin(), other.samples_.end());
+    failures_ += other.failures_;
+    other.samples_.clear();
+    other.failures_ = 0;
+}
+
+BenchmarkResult LatencySamples::summarise() {
+    BenchmarkResult result;
+    result.name = name_;
+    result.operations = samples_.size();
+    result.failures = failures_;
+    if (samples_.empty()) return result;
+
+    std::sort(samples_.begin(), samples_.end());
+    std::chrono::steady_clock::duration total{};
+    for (const auto& sample : samples_) total += sample;
+
+    const double totalUs = Micros(total).count();
+    result.meanUs = totalUs / samples_.size();
+    result.opsPerSecond = totalUs > 0 ? samples_.size() * 1e6 / totalUs : 0;
+    result.p50Us = percentileUs(samples_, 0.50);
+    result.p99Us = percentileUs(samples_, 0.99);
+    result.p999Us = percentileUs(samples_, 0.999);
+    return result;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <QJsonObject>
+
+// Latency summary for one benchmarked operation. Times are in microseconds and
+// opsPerSecond is computed from the time spent inside the operation only.
+struct BenchmarkResult {
+    std::string name;
+    std::size_t operations = 0;
+    std::size_t failures = 0;
+    double opsPerSecond = 0;
+    double meanUs = 0;
+    double p50Us = 0;
+    double p99Us = 0;
+    double p999Us = 0;
+
+    QJsonObject toJson() const;
+};
+
+// Collects one latency sample per call of time().
+class LatencySamples {
+public:
+    explicit LatencySamples(std::string name, std::size_t expected = 0);
+
+    // Runs op, records how long it took, and returns its result.
+    template <typename Op>
+    auto time(Op&& op) {
+        const auto start = std::chrono::steady_clock::now();
+        auto result = op();
+        samples_.push_back(std::chrono::steady_clock::now() - start);
+        return result;
+    }
+
+    void addFailure() { ++failures_; }
+    // Takes over other's samples and failures, e.g. to combine per-thread collectors.
+    void merge(LatencySamples&& other);
+
+    BenchmarkResult summarise();
+
+private:
+    std::string name_;
+    std::vector<std::chrono::steady_clock::duration> samples_;
+    std::size_t failures_ = 0;
+};
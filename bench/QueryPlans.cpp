@@ -0,0 +1,102 @@
+#include "QueryPlans.h"
+
+#include <QDebug>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <cstdio>
+#include <vector>
+
+#include "models/Migrations.h"
+
+namespace {
+
+struct HotQuery {
+    const char* caller;
+    const char* sql;            // as in LibrarySystem, with ? for every bound value
+};
+
+// Keep in step with the statements in LibrarySystem.cpp. Startup loads and whole-table
+// exports read everything on purpose and are left out.
+const std::vector<HotQuery>& hotQueries() {
+    static const std::vector<HotQuery> all = {
+        { "borrowItem (check out)",
+          "UPDATE items SET status_ = 'CheckedOut' WHERE itemid_ = ? AND status_ = 'Available' "
+          "AND NOT EXISTS (SELECT 1 FROM loans WHERE itemid_ = ?)" },
+        { "borrowItem (consume hold)", "DELETE FROM holds WHERE itemid_ = ? AND userid_ = ?" },
+        { "returnItem", "DELETE FROM loans WHERE itemid_ = ? AND userid_ = ?" },
+        { "placeHold",
+          "INSERT INTO holds (itemid_, userid_) SELECT ?, ? "
+          "WHERE NOT EXISTS (SELECT 1 FROM loans WHERE itemid_ = ? AND userid_ = ?)" },
+        { "cancelHold", "DELETE FROM holds WHERE userid_ = ? AND itemid_ = ?" },
+        { "getAccountLoans",
+          "SELECT l.dueDate_, i.itemid_, i.title_ FROM loans l JOIN items i ON i.itemid_ = l.itemid_ "
+          "WHERE l.userid_ = ?" },
+        { "isLoanedBy", "SELECT userid_ FROM loans WHERE itemid_ = ? AND userid_ = ?" },
+        { "removeItemFromCatalogue (holds)", "DELETE FROM holds WHERE itemid_ = ?" },
+        { "removeItemFromCatalogue (item)",
+          "DELETE FROM items WHERE itemid_ = ? AND status_ = 'Available' "
+          "AND NOT EXISTS (SELECT 1 FROM loans WHERE itemid_ = ?)" },
+        { "assessFines (patron bounds)",
+          "SELECT (SELECT MIN(userid_) FROM loans), (SELECT MAX(userid_) FROM loans)" },
+        { "assessFines (overdue range)",
+          "SELECT loanid_, userid_, itemid_, dueDate_ FROM loans "
+          "WHERE userid_ BETWEEN ? AND ? AND dueDate_ < ? ORDER BY userid_" },
+    };
+    return all;
+}
+
+// "SCAN loans", or "SCAN TABLE loans" before SQLite 3.36; a constant row is not a table.
+bool isScan(const QString& detail) {
+    return detail.startsWith("SCAN ") && !detail.startsWith("SCAN CONSTANT ROW");
+}
+
+bool checkPlans(QSqlDatabase& db) {
+    bool allSearch = true;
+    QSqlQuery query(db);
+    for (const HotQuery& hot : hotQueries()) {
+        const QString sql = hot.sql;
+        if (!query.prepare("EXPLAIN QUERY PLAN " + sql)) {
+            qDebug() << "ERROR:" << hot.caller << query.lastError().text();
+            allSearch = false;
+            continue;
+        }
+        for (int i = 0; i < sql.count('?'); ++i) query.addBindValue(1);
+        if (!query.exec()) {
+            qDebug() << "ERROR:" << hot.caller << query.lastError().text();
+            allSearch = false;
+            continue;
+        }
+
+        std::printf("\n%s\n", hot.caller);
+        while (query.next()) {
+            const QString detail = query.value("detail").toString();
+            const bool scan = isScan(detail);
+            allSearch = allSearch && !scan;
+            std::printf("  %s %s\n", scan ? "FAIL" : "ok  ", qPrintable(detail));
+        }
+    }
+    return allSearch;
+}
+
+} // namespace
+
+bool checkQueryPlans(const QString& databasePath) {
+    const QString connectionName = "hinlibs-bench-plans";
+    bool allSearch = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(databasePath);
+        if (!db.open()) {
+            qDebug() << "ERROR: cannot open" << databasePath;
+        } else if (!hinlibs::runMigrations(db)) {
+            qDebug() << "ERROR: cannot migrate" << databasePath;
+        } else {
+            allSearch = checkPlans(db);
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    std::printf("\nquery plans: %s\n", allSearch ? "every hot query searches an index" : "FAILED");
+    return allSearch;
+}
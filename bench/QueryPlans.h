@@ -0,0 +1,7 @@
+#pragma once
+#include <QString>
+
+// Runs EXPLAIN QUERY PLAN for the loans and holds statements on the checkout, hold and
+// account paths against a migrated copy of databasePath, and prints each plan. Returns
+// false if any of them scans a table or index instead of searching it.
+bool checkQueryPlans(const QString& databasePath);
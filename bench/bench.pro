@@ -0,0 +1,19 @@
+QT = core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+TARGET = hinlibs-bench
+
+include(../models/models.pri)
+include(../db/db.pri)
+
+SOURCES += \
+    main.cpp \
+    Benchmark.cpp \
+    QueryPlans.cpp
+
+HEADERS += \
+    Benchmark.h \
+    QueryPlans.h
+
+INCLUDEPATH += $$PWD
@@ -0,0 +1,591 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QThread>
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#include "Benchmark.h"
+#include "QueryPlans.h"
+#include "models/Book.h"
+#include "models/DatasetGenerator.h"
+#include "models/LibrarySystem.h"
+#include "models/Magazine.h"
+#include "models/Movie.h"
+#include "models/VideoGame.h"
+
+using namespace hinlibs;
+
+namespace {
+
+constexpr std::size_t SUGGESTION_LIMIT = 200;     // CatalogueModel's search page
+
+// Ids and names the suite draws its arguments from, read from the database under test.
+struct Workload {
+    std::vector<int> borrowers;       // patrons below the loan limit
+    std::vector<int> freeItems;       // Available items with no holds, so any borrower may take them
+    std::vector<int> loanedItems;     // CheckedOut items, which accept holds
+    std::vector<int> patronIds;
+    std::vector<std::string> patronNames;
+};
+
+std::vector<int> selectIds(QSqlQuery& query, const QString& sql) {
+    std::vector<int> ids;
+    if (query.exec(sql)) {
+        while (query.next()) ids.push_back(query.value(0).toInt());
+    }
+    return ids;
+}
+
+Workload loadWorkload(const QString& databasePath) {
+    const QString connectionName = "hinlibs-bench-workload";
+    Workload workload;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(databasePath);
+        db.setConnectOptions("QSQLITE_OPEN_READONLY");
+        if (db.open()) {
+            QSqlQuery query(db);
+            workload.borrowers = selectIds(query, QString(
+                "SELECT u.userid_ FROM users u LEFT JOIN loans l ON l.userid_ = u.userid_ "
+                "WHERE u.role_ = 'Patron' GROUP BY u.userid_ HAVING COUNT(l.loanid_) < %1 LIMIT 256")
+                .arg(LibrarySystem::MAX_ACTIVE_LOANS));
+            workload.freeItems = selectIds(query,
+                "SELECT i.itemid_ FROM items i WHERE i.status_ = 'Available' "
+                "AND NOT EXISTS (SELECT 1 FROM holds h WHERE h.itemid_ = i.itemid_) LIMIT 1024");
+            workload.loanedItems = selectIds(query, "SELECT itemid_ FROM loans LIMIT 1024");
+            if (query.exec("SELECT userid_, name_ FROM users WHERE role_ = 'Patron'")) {
+                while (query.next()) {
+                    workload.patronIds.push_back(query.value(0).toInt());
+                    workload.patronNames.push_back(query.value(1).toString().toStdString());
+                }
+            }
+            db.close();
+        } else {
+            qDebug() << "ERROR: cannot open" << databasePath;
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return workload;
+}
+
+// One heap object per item, as LibrarySystem cached the catalogue before ItemStore; only
+// built to time the scans below against it.
+std::vector<std::shared_ptr<Item>> makeItemObjects(const ItemStore& items) {
+    std::vector<std::shared_ptr<Item>> objects;
+    objects.reserve(items.size());
+    for (std::size_t slot = 0; slot < items.size(); ++slot) {
+        const ItemView item = items.view(slot);
+        const std::string title(item.title());
+        const std::string creator(item.creator());
+        const auto text = [](std::optional<std::string_view> value) {
+            return value ? std::optional<std::string>(std::string(*value)) : std::nullopt;
+        };
+        switch (item.catalogueKind()) {
+        case CatalogueKind::FictionBook:
+        case CatalogueKind::NonFictionBook:
+            objects.push_back(std::make_shared<Book>(item.id(), title, creator, item.publicationYear(),
+                item.catalogueKind() == CatalogueKind::FictionBook ? BookType::Fiction : BookType::NonFiction,
+                text(item.dewey()), text(item.isbn()), item.status()));
+            break;
+        case CatalogueKind::Magazine:
+            objects.push_back(std::make_shared<Magazine>(item.id(), title, creator, item.publicationYear(),
+                item.issueNumber().value_or(0), item.publicationDate(), item.status()));
+            break;
+        case CatalogueKind::Movie:
+            objects.push_back(std::make_shared<Movie>(item.id(), title, creator, item.publicationYear(),
+                text(item.genre()).value_or(""), text(item.rating()).value_or(""), item.status()));
+            break;
+        case CatalogueKind::VideoGame:
+            objects.push_back(std::make_shared<VideoGame>(item.id(), title, creator, item.publicationYear(),
+                text(item.genre()).value_or(""), text(item.rating()).value_or(""), item.status()));
+            break;
+        }
+    }
+    return objects;
+}
+
+// Each borrow is undone by a return, so every iteration starts from the same loan state.
+void timeCheckouts(LibrarySystem& system, const Workload& workload, std::size_t n,
+                   std::vector<BenchmarkResult>& results) {
+    LatencySamples borrow("borrowItem", n), giveBack("returnItem", n);
+    if (!workload.borrowers.empty() && !workload.freeItems.empty()) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const int patronId = workload.borrowers[i % workload.borrowers.size()];
+            const int itemId = workload.freeItems[i % workload.freeItems.size()];
+            if (!borrow.time([&] { return system.borrowItem(patronId, itemId); })) {
+                borrow.addFailure();
+                continue;
+            }
+            if (!giveBack.time([&] { return system.returnItem(patronId, itemId); })) giveBack.addFailure();
+        }
+    }
+    results.push_back(borrow.summarise());
+    results.push_back(giveBack.summarise());
+}
+
+// borrowItem as it was before the single-transaction checkout: seven statements, each
+// compiled on the call and committed on its own.
+bool borrowInAutocommit(QSqlDatabase& db, int patronId, int itemId) {
+    QSqlQuery query(db);
+    query.prepare("SELECT * FROM users WHERE userid_ = :patronId");
+    query.bindValue(":patronId", patronId);
+    if (!query.exec() || !query.next() || query.value("role_").toString() != "Patron") return false;
+
+    query.prepare("SELECT * FROM items WHERE itemid_ = :itemId");
+    query.bindValue(":itemId", itemId);
+    if (!query.exec() || !query.next() || query.value("status_").toString() != "Available") return false;
+
+    query.prepare("SELECT * FROM holds WHERE itemid_ = :itemId ORDER BY holdid_ ASC");
+    query.bindValue(":itemId", itemId);
+    if (!query.exec()) return false;
+    if (query.next()) {
+        if (query.value("userid_").toInt() != patronId) return false;
+        query.prepare("DELETE FROM holds WHERE itemid_ = :itemId AND userid_ = :patronId");
+        query.bindValue(":itemId", itemId);
+        query.bindValue(":patronId", patronId);
+        if (!query.exec()) return false;
+    }
+
+    query.prepare("SELECT * FROM loans WHERE itemid_ = :itemId AND userid_ = :patronId");
+    query.bindValue(":itemId", itemId);
+    query.bindValue(":patronId", patronId);
+    if (!query.exec() || query.next()) return false;
+
+    query.prepare("UPDATE items SET status_ = 'CheckedOut' WHERE itemid_ = :itemId");
+    query.bindValue(":itemId", itemId);
+    if (!query.exec()) return false;
+
+    query.prepare("INSERT INTO loans (userid_, itemid_, checkoutDate_, dueDate_) "
+                  "VALUES (:patronId, :itemId, :checkoutDate_, :dueDate_)");
+    query.bindValue(":patronId", patronId);
+    query.bindValue(":itemId", itemId);
+    query.bindValue(":checkoutDate_", QDate::currentDate().toString("yyyy-MM-dd"));
+    query.bindValue(":dueDate_", QDate::currentDate().addDays(LibrarySystem::LOAN_PERIOD_DAYS).toString("yyyy-MM-dd"));
+    return query.exec();
+}
+
+// Checkouts per second on the old autocommit path, for comparison with borrowItem. Runs
+// on its own connection with the profile's PRAGMAs, and undoes each loan (untimed) so
+// the database is back in the state the LibrarySystem under test has cached. Free items
+// have no holds, so no hold is ever consumed.
+void timeAutocommitCheckouts(const QString& databasePath, const DatabaseProfile& profile,
+                             const Workload& workload, std::size_t n, std::vector<BenchmarkResult>& results) {
+    const QString connectionName = "hinlibs-bench-autocommit";
+    LatencySamples borrow("borrowItem (autocommit)", n);
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(databasePath);
+        if (!db.open()) {
+            qDebug() << "ERROR: cannot open" << databasePath;
+        } else if (!workload.borrowers.empty() && !workload.freeItems.empty()) {
+            QSqlQuery setup(db);
+            for (const QString& pragma : profile.pragmas()) setup.exec(pragma);
+
+            QSqlQuery undoLoan(db), undoStatus(db);
+            undoLoan.prepare("DELETE FROM loans WHERE itemid_ = :itemId AND userid_ = :patronId");
+            undoStatus.prepare("UPDATE items SET status_ = 'Available' WHERE itemid_ = :itemId");
+            for (std::size_t i = 0; i < n; ++i) {
+                const int patronId = workload.borrowers[i % workload.borrowers.size()];
+                const int itemId = workload.freeItems[i % workload.freeItems.size()];
+                if (!borrow.time([&] { return borrowInAutocommit(db, patronId, itemId); })) borrow.addFailure();
+                undoLoan.bindValue(":itemId", itemId);
+                undoLoan.bindValue(":patronId", patronId);
+                undoStatus.bindValue(":itemId", itemId);
+                if (!undoLoan.exec() || !undoStatus.exec()) qDebug() << "ERROR:" << db.lastError().text();
+            }
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    results.push_back(borrow.summarise());
+}
+
+std::vector<BenchmarkResult> runSuite(LibrarySystem& system, const Workload& workload,
+                                      int iterations, std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    auto pick = [&rng](const auto& values) { return values[rng() % values.size()]; };
+    const std::size_t n = static_cast<std::size_t>(iterations);
+    std::vector<BenchmarkResult> results;
+
+    timeCheckouts(system, workload, n, results);
+
+    // Each hold is undone by a cancel, so every iteration starts from the same hold state.
+    LatencySamples place("placeHold", n), cancel("cancelHold", n);
+    if (!workload.borrowers.empty() && !workload.loanedItems.empty()) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const int itemId = workload.loanedItems[i % workload.loanedItems.size()];
+            const int patronId = workload.borrowers[(i + i / workload.loanedItems.size()) % workload.borrowers.size()];
+            if (!place.time([&] { return system.placeHold(patronId, itemId); })) {
+                place.addFailure();
+                continue;
+            }
+            if (!cancel.time([&] { return system.cancelHold(patronId, itemId); })) cancel.addFailure();
+        }
+    }
+    results.push_back(place.summarise());
+    results.push_back(cancel.summarise());
+
+    if (!workload.patronIds.empty()) {
+        LatencySamples loans("getAccountLoans", n), holds("getAccountHolds", n);
+        for (std::size_t i = 0; i < n; ++i) {
+            const int patronId = pick(workload.patronIds);
+            loans.time([&] { return system.getAccountLoans(patronId).size(); });
+            holds.time([&] { return system.getAccountHolds(patronId).size(); });
+        }
+        results.push_back(loans.summarise());
+        results.push_back(holds.summarise());
+
+        LatencySamples find("LibrarianFindPatronByName", n);
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::string& name = pick(workload.patronNames);
+            if (!find.time([&] { return system.LibrarianFindPatronByName(name); })) find.addFailure();
+        }
+        results.push_back(find.summarise());
+    }
+
+    const auto& items = system.allItems();
+    if (!items.empty()) {
+        LatencySamples byId("getItemById", n);
+        for (std::size_t i = 0; i < n; ++i) {
+            const int itemId = pick(items.ids());
+            if (!byId.time([&] { return system.getItemById(itemId); })) byId.addFailure();
+        }
+        results.push_back(byId.summarise());
+
+        // The same lookups as a linear walk over the id column, i.e. getItemById without
+        // ItemStore's id -> slot index; at most 200 calls, since each one costs O(items).
+        const std::size_t walks = std::min<std::size_t>(n, 200);
+        LatencySamples byScan("getItemById (scan)", walks);
+        for (std::size_t i = 0; i < walks; ++i) {
+            const int itemId = pick(items.ids());
+            const bool found = byScan.time([&] {
+                const auto& ids = items.ids();
+                const auto at = std::find(ids.begin(), ids.end(), itemId);
+                return at != ids.end() && items.view(static_cast<std::size_t>(at - ids.begin()));
+            });
+            if (!found) byScan.addFailure();
+        }
+        results.push_back(byScan.summarise());
+
+        // Search-as-you-type: the first two to six letters of a word from a random title,
+        // at the page size the catalogue view asks for.
+        LatencySamples suggest("suggestItemIds", n);
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::string title(items.title(rng() % items.size()));
+            std::vector<std::string> words;
+            std::istringstream split(title);
+            for (std::string word; split >> word;) words.push_back(word);
+            if (words.empty()) continue;
+            const std::string typed = pick(words).substr(0, 2 + rng() % 5);
+            suggest.time([&] { return system.suggestItemIds(typed, SUGGESTION_LIMIT).size(); });
+        }
+        results.push_back(suggest.summarise());
+    }
+
+    {
+        // Whole-catalogue passes over allItems(), and the same passes over one object per item
+        // as the cache held before ItemStore. The objects are freed before the fines runs.
+        const std::size_t scans = std::min<std::size_t>(n, 100);
+        const auto objects = makeItemObjects(items);
+        LatencySamples countStore("count Available", scans), countObjects("count Available (objects)", scans);
+        LatencySamples titlesStore("scan titles and years", scans), titlesObjects("scan titles and years (objects)", scans);
+        for (std::size_t i = 0; i < scans; ++i) {
+            countStore.time([&] {
+                const auto& statuses = system.allItems().statuses();
+                return std::count(statuses.begin(), statuses.end(), ItemStatus::Available);
+            });
+            countObjects.time([&] {
+                return std::count_if(objects.begin(), objects.end(),
+                                     [](const auto& item) { return item->status() == ItemStatus::Available; });
+            });
+            titlesStore.time([&] {
+                std::size_t total = 0;
+                for (std::size_t slot = 0; slot < items.size(); ++slot) {
+                    total += items.title(slot).size() + static_cast<std::size_t>(items.publicationYears()[slot]);
+                }
+                return total;
+            });
+            titlesObjects.time([&] {
+                std::size_t total = 0;
+                for (const auto& item : objects) {
+                    total += item->title().size() + static_cast<std::size_t>(item->publicationYear());
+                }
+                return total;
+            });
+        }
+        results.push_back(countStore.summarise());
+        results.push_back(countObjects.summarise());
+        results.push_back(titlesStore.summarise());
+        results.push_back(titlesObjects.summarise());
+    }
+
+    // Whole-table job: a few runs suffice, and each one rewrites the same fines rows.
+    const std::size_t fineRuns = std::min<std::size_t>(n, 5);
+    for (int threads : { 1, 4 }) {
+        LatencySamples fines(threads == 1 ? "assessFines" : "assessFines x4", fineRuns);
+        for (std::size_t i = 0; i < fineRuns; ++i) {
+            if (!fines.time([&] { return system.assessFines(QDate::currentDate(), threads).completed; })) {
+                fines.addFailure();
+            }
+        }
+        results.push_back(fines.summarise());
+    }
+
+    return results;
+}
+
+// getAccountLoans on 1, 2, ... cores threads at once, each thread on its own read
+// connection while the pool has read-only slots left. Every thread makes the same number
+// of calls; ops/sec is the combined rate over wall-clock time, so flat rows mean the
+// reads serialise somewhere.
+std::vector<BenchmarkResult> runReadScaling(LibrarySystem& system, const Workload& workload,
+                                            int iterations, std::uint64_t seed) {
+    std::vector<BenchmarkResult> results;
+    if (workload.patronIds.empty()) return results;
+    const std::size_t perThread = static_cast<std::size_t>(iterations);
+
+    for (int threads = 1; threads <= std::max(1, QThread::idealThreadCount()); ++threads) {
+        std::vector<LatencySamples> samples;
+        for (int t = 0; t < threads; ++t) samples.emplace_back("", perThread);
+
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> readers;
+        for (int t = 0; t < threads; ++t) {
+            readers.emplace_back([&, t]() {
+                std::mt19937_64 rng(seed + static_cast<std::uint64_t>(t));
+                for (std::size_t i = 0; i < perThread; ++i) {
+                    const int patronId = workload.patronIds[rng() % workload.patronIds.size()];
+                    samples[t].time([&] { return system.getAccountLoans(patronId).size(); });
+                }
+            });
+        }
+        for (std::thread& reader : readers) reader.join();
+        const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        LatencySamples all(QString("getAccountLoans x%1 threads").arg(threads).toStdString(), perThread * threads);
+        for (LatencySamples& s : samples) all.merge(std::move(s));
+        BenchmarkResult result = all.summarise();
+        result.opsPerSecond = wallSeconds > 0 ? result.operations / wallSeconds : 0;
+        results.push_back(result);
+    }
+    return results;
+}
+
+void printResults(const QString& profile, double startupSeconds, std::size_t itemStoreBytes,
+                  const std::vector<BenchmarkResult>& results);
+
+// Checkout cost against catalogues of each size: spec with only the item count changed
+// (loans and holds capped at a tenth and a twentieth of the catalogue). Also times the
+// full catalogue reload that every mutation ended with before the cache was
+// write-through, for comparison. Appends one run per size to runs.
+bool runCheckoutScaling(const DatabaseProfile& profile, const DatasetSpec& spec, const QStringList& sizes,
+                        int iterations, const QTemporaryDir& workDir, QJsonArray& runs) {
+    for (const QString& size : sizes) {
+        DatasetSpec sized = spec;
+        sized.items = size.trimmed().toInt();
+        if (sized.items <= 0) continue;
+        sized.loans = std::min(spec.loans, sized.items / 10);
+        sized.holds = std::min(spec.holds, sized.items / 20);
+
+        const QString path = workDir.filePath(QString("%1-%2.sqlite3").arg(profile.name).arg(sized.items));
+        if (!generateDataset(path, sized)) {
+            qDebug() << "ERROR: cannot generate" << sized.items << "items for profile" << profile.name;
+            return false;
+        }
+
+        std::vector<BenchmarkResult> results;
+        double startupSeconds = 0;
+        std::size_t itemStoreBytes = 0;
+        {
+            const auto start = std::chrono::steady_clock::now();
+            LibrarySystem system(path, profile);
+            startupSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            itemStoreBytes = system.allItems().memoryUsage();
+
+            const Workload workload = loadWorkload(path);
+            timeCheckouts(system, workload, static_cast<std::size_t>(iterations), results);
+            timeAutocommitCheckouts(path, profile, workload, static_cast<std::size_t>(iterations), results);
+
+            const std::size_t reloads = std::min<std::size_t>(static_cast<std::size_t>(iterations), 5);
+            LatencySamples reload("getItemsFromDB", reloads);
+            for (std::size_t i = 0; i < reloads; ++i) {
+                reload.time([&] {
+                    system.getItemsFromDB();
+                    return system.allItems().size();
+                });
+            }
+            results.push_back(reload.summarise());
+        }
+        printResults(QString("%1, %2 items").arg(profile.name).arg(sized.items), startupSeconds, itemStoreBytes, results);
+
+        QJsonArray operations;
+        for (const auto& r : results) operations.append(r.toJson());
+        runs.append(QJsonObject{
+            { "profile", profile.name },
+            { "catalogueItems", sized.items },
+            { "startupSeconds", startupSeconds },
+            { "operations", operations },
+        });
+    }
+    return true;
+}
+
+void printResults(const QString& profile, double startupSeconds, std::size_t itemStoreBytes,
+                  const std::vector<BenchmarkResult>& results) {
+    std::printf("\nprofile %s (startup %.3f s, item store %.1f MiB)\n", qPrintable(profile), startupSeconds,
+                itemStoreBytes / (1024.0 * 1024.0));
+    std::printf("%-26s %9s %12s %10s %10s %10s %8s\n", "operation", "ops", "ops/sec", "p50 us", "p99 us", "p999 us", "failed");
+    for (const auto& r : results) {
+        std::printf("%-26s %9zu %12.0f %10.1f %10.1f %10.1f %8zu\n", r.name.c_str(), r.operations,
+                    r.opsPerSecond, r.p50Us, r.p99Us, r.p999Us, r.failures);
+    }
+}
+
+} // namespace
+
+// hinlibs-bench [--items N] [--patrons N] [--loans N] [--holds N] [--seed N]
+//               [--iterations N] [--profiles a,b] [--db PATH] [--out FILE] [--check-plans]
+//               [--checkout-sizes a,b]
+// Runs the suite once per profile, each against a fresh copy of the same database,
+// and writes all results to a JSON file. With --checkout-sizes it instead times
+// checkouts against a generated catalogue of each size, per profile. With --check-plans it only checks the query
+// plans of the hot loans and holds statements, and exits with 1 if any of them scans.
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("hinlibs-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Microbenchmarks for the LibrarySystem hot paths.");
+    parser.addHelpOption();
+    const DatasetSpec defaults;
+    QCommandLineOption itemsOption("items", "Generated items.", "n", QString::number(defaults.items));
+    QCommandLineOption patronsOption("patrons", "Generated patrons.", "n", QString::number(defaults.patrons));
+    QCommandLineOption loansOption("loans", "Generated loans.", "n", QString::number(defaults.loans));
+    QCommandLineOption holdsOption("holds", "Generated holds.", "n", QString::number(defaults.holds));
+    QCommandLineOption seedOption("seed", "Dataset and workload seed.", "n", QString::number(defaults.seed));
+    QCommandLineOption iterationsOption("iterations", "Calls per operation.", "n", "2000");
+    QCommandLineOption profilesOption("profiles", "Comma-separated database profiles to compare.", "names", "balanced");
+    QCommandLineOption dbOption("db", "Benchmark a copy of this database instead of generating one.", "path");
+    QCommandLineOption outOption("out", "JSON results file.", "file", "bench-results.json");
+    QCommandLineOption checkPlansOption("check-plans", "Fail if a hot loans or holds query scans instead of searching.");
+    QCommandLineOption checkoutSizesOption("checkout-sizes",
+                                           "Time checkouts on generated catalogues of these sizes instead of the suite.",
+                                           "n,n");
+    parser.addOptions({ itemsOption, patronsOption, loansOption, holdsOption, seedOption,
+                        iterationsOption, profilesOption, dbOption, outOption, checkPlansOption,
+                        checkoutSizesOption });
+    parser.process(app);
+
+    DatasetSpec spec;
+    spec.items = parser.value(itemsOption).toInt();
+    spec.patrons = parser.value(patronsOption).toInt();
+    spec.loans = parser.value(loansOption).toInt();
+    spec.holds = parser.value(holdsOption).toInt();
+    spec.seed = parser.value(seedOption).toULongLong();
+    const int iterations = std::max(1, parser.value(iterationsOption).toInt());
+
+    QTemporaryDir workDir;
+    if (!workDir.isValid()) {
+        qDebug() << "ERROR: cannot create a temporary directory";
+        return 1;
+    }
+
+    if (parser.isSet(checkPlansOption)) {
+        const QString path = workDir.filePath("plans.sqlite3");
+        const bool prepared = parser.isSet(dbOption) ? QFile::copy(parser.value(dbOption), path)
+                                                     : generateDataset(path, spec);
+        if (!prepared) {
+            qDebug() << "ERROR: cannot prepare the database for the plan check";
+            return 1;
+        }
+        return checkQueryPlans(path) ? 0 : 1;
+    }
+
+    QJsonArray runs;
+    for (const QString& profileName : parser.value(profilesOption).split(',')) {
+        if (profileName.trimmed().isEmpty()) continue;
+        const DatabaseProfile profile = DatabaseProfile::named(profileName);
+        if (parser.isSet(checkoutSizesOption)) {
+            if (!runCheckoutScaling(profile, spec, parser.value(checkoutSizesOption).split(','), iterations, workDir, runs)) {
+                return 1;
+            }
+            continue;
+        }
+        const QString path = workDir.filePath(profile.name + ".sqlite3");
+
+        const bool prepared = parser.isSet(dbOption) ? QFile::copy(parser.value(dbOption), path)
+                                                     : generateDataset(path, spec);
+        if (!prepared) {
+            qDebug() << "ERROR: cannot prepare the database for profile" << profile.name;
+            return 1;
+        }
+
+        std::vector<BenchmarkResult> results;
+        double startupSeconds = 0;
+        std::size_t itemStoreBytes = 0;
+        ActivityLogStats activity{ 0, 0, 0 };
+        {
+            // Startup covers migrations (index and search-index builds) and the cache load.
+            const auto start = std::chrono::steady_clock::now();
+            LibrarySystem system(path, profile);
+            startupSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            itemStoreBytes = system.allItems().memoryUsage();
+
+            const Workload workload = loadWorkload(path);
+            results = runSuite(system, workload, iterations, spec.seed);
+            for (BenchmarkResult& r : runReadScaling(system, workload, iterations, spec.seed)) {
+                results.push_back(std::move(r));
+            }
+            timeAutocommitCheckouts(path, profile, workload, static_cast<std::size_t>(iterations), results);
+            system.flushActivityLog();
+            activity = system.activityLogStats();
+        }
+        printResults(profile.name, startupSeconds, itemStoreBytes, results);
+
+        QJsonArray operations;
+        for (const auto& r : results) operations.append(r.toJson());
+        runs.append(QJsonObject{
+            { "profile", profile.name },
+            { "pragmas", QJsonArray::fromStringList(profile.pragmas()) },
+            { "startupSeconds", startupSeconds },
+            { "itemStoreBytes", static_cast<qint64>(itemStoreBytes) },
+            { "activityLog", QJsonObject{ { "logged", static_cast<qint64>(activity.logged) },
+                                          { "written", static_cast<qint64>(activity.written) },
+                                          { "dropped", static_cast<qint64>(activity.dropped) } } },
+            { "operations", operations },
+        });
+    }
+
+    const QJsonObject report{
+        { "timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate) },
+        { "iterations", iterations },
+        { "dataset", parser.isSet(dbOption)
+                         ? QJsonObject{ { "path", parser.value(dbOption) } }
+                         : QJsonObject{ { "seed", QString::number(spec.seed) }, { "items", spec.items },
+                                        { "patrons", spec.patrons }, { "loans", spec.loans },
+                                        { "holds", spec.holds } } },
+        { "runs", runs },
+    };
+
+    QFile out(parser.value(outOption));
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "ERROR: cannot write" << out.fileName();
+        return 1;
+    }
+    out.write(QJsonDocument(report).toJson());
+    std::printf("\nresults written to %s\n", qPrintable(out.fileName()));
+    return 0;
+}
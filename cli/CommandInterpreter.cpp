@@ -0,0 +1,447 @@
+#include "CommandInterpreter.h"
+
+#include <QFile>
+#include <charconv>
+#include <istream>
+#include <ostream>
+
+using namespace hinlibs;
+
+namespace {
+
+const char* statusName(ItemStatus status) {
+    return status == ItemStatus::Available ? "Available" : "CheckedOut";
+}
+
+const char* roleName(Role role) {
+    switch (role) {
+    case Role::Patron:        return "Patron";
+    case Role::Librarian:     return "Librarian";
+    case Role::Administrator: return "Administrator";
+    }
+    return "Unknown";
+}
+
+std::optional<ItemFacet> facetFromName(const std::string& name) {
+    if (name == "kind") return ItemFacet::Kind;
+    if (name == "creator") return ItemFacet::Creator;
+    if (name == "genre") return ItemFacet::Genre;
+    if (name == "rating") return ItemFacet::Rating;
+    return std::nullopt;
+}
+
+std::string joinFrom(const std::vector<std::string>& args, std::size_t first) {
+    std::string joined;
+    for (std::size_t i = first; i < args.size(); ++i) {
+        if (!joined.empty()) joined += ' ';
+        joined += args[i];
+    }
+    return joined;
+}
+
+} // namespace
+
+CommandInterpreter::CommandInterpreter(LibrarySystem& system, std::ostream& out, std::ostream& err)
+    : system_(system), out_(out), err_(err) {}
+
+const std::vector<CommandInterpreter::Command>& CommandInterpreter::commands() {
+    static const std::vector<Command> table = {
+        { "borrow",      "borrow <patronId> <itemId>",                  2, &CommandInterpreter::borrow },
+        { "return",      "return <patronId> <itemId>",                  2, &CommandInterpreter::giveBack },
+        { "hold",        "hold <patronId> <itemId>",                    2, &CommandInterpreter::hold },
+        { "cancel-hold", "cancel-hold <patronId> <itemId>",             2, &CommandInterpreter::cancelHold },
+        { "add",         "add <librarianId> <kind> <title> <creator> <year> [isbn=|dewey=|issue=|date=|genre=|rating=...]",
+                                                                        5, &CommandInterpreter::add },
+        { "remove",      "remove <librarianId> <itemId>",               2, &CommandInterpreter::remove },
+        { "import",      "import <librarianId> <file> [csv|jsonl]",     2, &CommandInterpreter::importCatalogue },
+        { "export",      "export <items|loans> <file|-> [csv|jsonl] [columns=a,b] [kind=|status=|from=|to=...]",
+                                                                        2, &CommandInterpreter::exportRecords },
+        { "fines",       "fines [yyyy-MM-dd] [threads=N]",              0, &CommandInterpreter::fines },
+        { "item",        "item <itemId>",                               1, &CommandInterpreter::item },
+        { "search",      "search <text...>",                            1, &CommandInterpreter::search },
+        { "facet",       "facet <kind|creator|genre|rating> [value...]", 1, &CommandInterpreter::facet },
+        { "loans",       "loans <patronId>",                            1, &CommandInterpreter::loans },
+        { "holds",       "holds <patronId>",                            1, &CommandInterpreter::holds },
+        { "overdue",     "overdue [patronId]",                          0, &CommandInterpreter::overdue },
+        { "user",        "user <name>",                                 1, &CommandInterpreter::user },
+        { "help",        "help",                                        0, &CommandInterpreter::help },
+    };
+    return table;
+}
+
+bool CommandInterpreter::execute(const std::vector<std::string>& args) {
+    if (args.empty()) return true;
+
+    for (const Command& command : commands()) {
+        if (args[0] != command.name) continue;
+        if (args.size() - 1 < command.minArgs) {
+            return fail(std::string("usage: ") + command.usage);
+        }
+        return (this->*command.run)(args);
+    }
+    return fail("unknown command '" + args[0] + "' (try 'help')");
+}
+
+int CommandInterpreter::runScript(std::istream& in) {
+    int failures = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        const auto first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') continue;
+        if (!execute(tokenize(line))) ++failures;
+    }
+    return failures;
+}
+
+std::vector<std::string> CommandInterpreter::tokenize(const std::string& line) {
+    std::vector<std::string> words;
+    std::string word;
+    bool inWord = false;
+    bool quoted = false;
+
+    for (std::size_t i = 0; i < line.size(); ++i) {
+        const char c = line[i];
+        if (c == '\\' && i + 1 < line.size() && line[i + 1] == '"') {
+            word += '"';
+            inWord = true;
+            ++i;
+        } else if (c == '"') {
+            quoted = !quoted;
+            inWord = true;
+        } else if (!quoted && (c == ' ' || c == '\t' || c == '\r')) {
+            if (inWord) words.push_back(std::move(word));
+            word.clear();
+            inWord = false;
+        } else {
+            word += c;
+            inWord = true;
+        }
+    }
+    if (inWord) words.push_back(std::move(word));
+    return words;
+}
+
+void CommandInterpreter::printUsage(std::ostream& os) const {
+    os << "Commands:\n";
+    for (const Command& command : commands()) {
+        os << "  " << command.usage << '\n';
+    }
+    os << "Kinds for add: FictionBook, NonFictionBook, Magazine, Movie, VideoGame (date is yyyy-MM-dd)\n";
+}
+
+// --- Patron operations ---
+
+bool CommandInterpreter::borrow(const std::vector<std::string>& args) {
+    int patronId = 0, itemId = 0;
+    if (!parseInt(args[1], "patronId", patronId) || !parseInt(args[2], "itemId", itemId)) return false;
+    if (!system_.borrowItem(patronId, itemId)) {
+        return fail("cannot borrow item " + args[2] + " (unavailable, queue fairness, or loan limit)");
+    }
+    out_ << "ok\n";
+    return true;
+}
+
+bool CommandInterpreter::giveBack(const std::vector<std::string>& args) {
+    int patronId = 0, itemId = 0;
+    if (!parseInt(args[1], "patronId", patronId) || !parseInt(args[2], "itemId", itemId)) return false;
+    if (!system_.returnItem(patronId, itemId)) {
+        return fail("item " + args[2] + " is not loaned by patron " + args[1]);
+    }
+    out_ << "ok\n";
+    return true;
+}
+
+bool CommandInterpreter::hold(const std::vector<std::string>& args) {
+    int patronId = 0, itemId = 0;
+    if (!parseInt(args[1], "patronId", patronId) || !parseInt(args[2], "itemId", itemId)) return false;
+    if (system_.isLoanedBy(itemId, patronId)) {
+        return fail("patron " + args[1] + " already has item " + args[2] + " checked out");
+    }
+    if (!system_.placeHold(patronId, itemId)) {
+        return fail("holds are only allowed on checked-out items, and duplicates are not allowed");
+    }
+    out_ << "ok\n";
+    return true;
+}
+
+bool CommandInterpreter::cancelHold(const std::vector<std::string>& args) {
+    int patronId = 0, itemId = 0;
+    if (!parseInt(args[1], "patronId", patronId) || !parseInt(args[2], "itemId", itemId)) return false;
+    if (!system_.cancelHold(patronId, itemId)) {
+        return fail("could not cancel the hold on item " + args[2]);
+    }
+    out_ << "ok\n";
+    return true;
+}
+
+// --- Librarian operations ---
+
+bool CommandInterpreter::add(const std::vector<std::string>& args) {
+    int librarianId = 0;
+    ItemInDB data;
+    if (!parseInt(args[1], "librarianId", librarianId)) return false;
+    if (!parseInt(args[5], "year", data.publicationYear_)) return false;
+
+    data.kind_ = args[2];
+    data.title_ = args[3];
+    data.creator_ = args[4];
+    data.status_ = ItemStatus::Available;
+    if (data.kind_ != "FictionBook" && data.kind_ != "NonFictionBook" && data.kind_ != "Magazine"
+        && data.kind_ != "Movie" && data.kind_ != "VideoGame") {
+        return fail("unknown kind '" + data.kind_ + "'");
+    }
+    if (data.title_.empty() || data.creator_.empty() || data.publicationYear_ <= 0) {
+        return fail("title and creator must not be empty and year must be positive");
+    }
+
+    for (std::size_t i = 6; i < args.size(); ++i) {
+        const auto eq = args[i].find('=');
+        if (eq == std::string::npos) return fail("expected key=value, got '" + args[i] + "'");
+        const std::string key = args[i].substr(0, eq);
+        const std::string value = args[i].substr(eq + 1);
+
+        if (key == "isbn") {
+            data.isbn_ = value;
+        } else if (key == "dewey") {
+            data.dewey_ = value;
+        } else if (key == "genre") {
+            data.genre_ = value;
+        } else if (key == "rating") {
+            data.rating_ = value;
+        } else if (key == "issue") {
+            int issue = 0;
+            if (!parseInt(value, "issue", issue)) return false;
+            data.issueNumber_ = issue;
+        } else if (key == "date") {
+            const QDate date = QDate::fromString(QString::fromStdString(value), "yyyy-MM-dd");
+            if (!date.isValid()) return fail("invalid date '" + value + "'");
+            data.publicationDate_ = date;
+        } else {
+            return fail("unknown field '" + key + "'");
+        }
+    }
+
+    if (!system_.addItemToCatalogue(librarianId, data)) {
+        return fail("could not add the item");
+    }
+    out_ << "ok\n";
+    return true;
+}
+
+bool CommandInterpreter::remove(const std::vector<std::string>& args) {
+    int librarianId = 0, itemId = 0;
+    if (!parseInt(args[1], "librarianId", librarianId) || !parseInt(args[2], "itemId", itemId)) return false;
+    if (!system_.removeItemFromCatalogue(librarianId, itemId)) {
+        return fail("could not remove item " + args[2]);
+    }
+    out_ << "ok\n";
+    return true;
+}
+
+bool CommandInterpreter::importCatalogue(const std::vector<std::string>& args) {
+    int librarianId = 0;
+    if (!parseInt(args[1], "librarianId", librarianId)) return false;
+
+    // Without an explicit format, *.csv is CSV and anything else is JSON Lines.
+    const QString path = QString::fromStdString(args[2]);
+    const std::string format = args.size() > 3 ? args[3]
+                             : (path.endsWith(".csv", Qt::CaseInsensitive) ? "csv" : "jsonl");
+    if (format != "csv" && format != "jsonl") return fail("format must be csv or jsonl");
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return fail("cannot open " + args[2]);
+
+    const ImportReport report = system_.importCatalogue(
+        librarianId, file, format == "csv" ? ImportFormat::Csv : ImportFormat::JsonLines);
+    for (const auto& rejection : report.rejected) {
+        err_ << args[2] << ':' << rejection.line << ": " << rejection.reason << '\n';
+    }
+    out_ << "imported " << report.imported << ", rejected " << report.rejected.size() << '\n';
+    if (!report.completed) return fail("import stopped early");
+    return true;
+}
+
+bool CommandInterpreter::exportRecords(const std::vector<std::string>& args) {
+    ExportOptions options;
+    if (args[1] == "items") {
+        options.table = ExportTable::Items;
+    } else if (args[1] == "loans") {
+        options.table = ExportTable::Loans;
+    } else {
+        return fail("export table must be items or loans");
+    }
+
+    // Without an explicit format, *.jsonl is JSON Lines and anything else (including stdout) is CSV.
+    const QString path = QString::fromStdString(args[2]);
+    const bool toStdout = path == "-";
+    options.format = path.endsWith(".jsonl", Qt::CaseInsensitive) ? ExportFormat::JsonLines : ExportFormat::Csv;
+
+    for (std::size_t i = 3; i < args.size(); ++i) {
+        if (args[i] == "csv" || args[i] == "jsonl") {
+            options.format = args[i] == "csv" ? ExportFormat::Csv : ExportFormat::JsonLines;
+            continue;
+        }
+        const auto eq = args[i].find('=');
+        if (eq == std::string::npos) return fail("expected key=value, got '" + args[i] + "'");
+        const std::string key = args[i].substr(0, eq);
+        const QString value = QString::fromStdString(args[i].substr(eq + 1));
+
+        if (key == "columns") {
+            options.columns = value.split(',');
+        } else if (key == "kind") {
+            options.kind = value.toStdString();
+        } else if (key == "status") {
+            if (value != "Available" && value != "CheckedOut") return fail("status must be Available or CheckedOut");
+            options.status = value == "Available" ? ItemStatus::Available : ItemStatus::CheckedOut;
+        } else if (key == "from" || key == "to") {
+            const QDate date = QDate::fromString(value, "yyyy-MM-dd");
+            if (!date.isValid()) return fail(key + " must be yyyy-MM-dd");
+            (key == "from" ? options.from : options.to) = date;
+        } else {
+            return fail("unknown option '" + key + "'");
+        }
+    }
+
+    QFile file;
+    bool opened = false;
+    if (toStdout) {
+        opened = file.open(stdout, QIODevice::WriteOnly);
+    } else {
+        file.setFileName(path);
+        opened = file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    }
+    if (!opened) return fail("cannot write " + args[2]);
+
+    out_.flush();
+    const qint64 rows = system_.exportRecords(options, file);
+    file.close();
+    if (rows < 0) return fail("export failed");
+    if (!toStdout) out_ << "exported " << rows << " rows\n";
+    return true;
+}
+
+// Prints each fined patron's count and total, then a summary line.
+bool CommandInterpreter::fines(const std::vector<std::string>& args) {
+    QDate assessedOn = QDate::currentDate();
+    int threads = 1;
+    for (std::size_t i = 1; i < args.size(); ++i) {
+        if (args[i].rfind("threads=", 0) == 0) {
+            if (!parseInt(args[i].substr(8), "threads", threads)) return false;
+            continue;
+        }
+        assessedOn = QDate::fromString(QString::fromStdString(args[i]), "yyyy-MM-dd");
+        if (!assessedOn.isValid()) return fail("date must be yyyy-MM-dd");
+    }
+
+    const FineReport report = system_.assessFines(assessedOn, threads);
+    if (!report.completed) return fail("fines run failed; fines table unchanged");
+    for (const auto& patron : report.byPatron) {
+        out_ << patron.patronId << '\t' << patron.fines << '\t' << patron.totalCents << '\n';
+    }
+    out_ << "fined " << report.finesWritten << " of " << report.overdueLoans << " overdue loans, "
+         << report.totalCents << " cents\n";
+    return true;
+}
+
+// --- Queries ---
+
+bool CommandInterpreter::item(const std::vector<std::string>& args) {
+    int itemId = 0;
+    if (!parseInt(args[1], "itemId", itemId)) return false;
+    auto found = system_.getItemById(itemId);
+    if (!found) return fail("no item " + args[1]);
+    printItem(found);
+    return true;
+}
+
+bool CommandInterpreter::search(const std::vector<std::string>& args) {
+    LibrarySystem::CatalogueSearch query;
+    query.text = joinFrom(args, 1);
+    for (const auto& found : system_.searchCatalogue(query)) {
+        printItem(found);
+    }
+    return true;
+}
+
+// Without a value, lists each value with its item count; with one, the items that have it.
+bool CommandInterpreter::facet(const std::vector<std::string>& args) {
+    const auto facet = facetFromName(args[1]);
+    if (!facet) return fail("facet must be kind, creator, genre or rating, got '" + args[1] + "'");
+
+    if (args.size() == 2) {
+        for (const auto& [value, count] : system_.facetCounts(*facet)) {
+            out_ << value << '\t' << count << '\n';
+        }
+        return true;
+    }
+    for (const auto& found : system_.itemsWithFacet(*facet, joinFrom(args, 2), FACET_ITEM_LIMIT)) {
+        printItem(found);
+    }
+    return true;
+}
+
+bool CommandInterpreter::loans(const std::vector<std::string>& args) {
+    int patronId = 0;
+    if (!parseInt(args[1], "patronId", patronId)) return false;
+    for (const auto& loan : system_.getAccountLoans(patronId)) {
+        out_ << loan.itemId << '\t' << loan.title << '\t'
+             << loan.dueDate.toString("yyyy-MM-dd").toStdString() << '\t' << loan.daysRemaining << '\n';
+    }
+    return true;
+}
+
+bool CommandInterpreter::holds(const std::vector<std::string>& args) {
+    int patronId = 0;
+    if (!parseInt(args[1], "patronId", patronId)) return false;
+    for (const auto& hold : system_.getAccountHolds(patronId)) {
+        out_ << hold.itemId << '\t' << hold.title << '\t' << hold.queuePosition << '\n';
+    }
+    return true;
+}
+
+// Without a patron, lists every overdue loan grouped by patron.
+bool CommandInterpreter::overdue(const std::vector<std::string>& args) {
+    int patronId = 0;
+    if (args.size() > 1 && !parseInt(args[1], "patronId", patronId)) return false;
+    system_.runDueDateCheck();
+    const auto found = args.size() > 1 ? system_.getOverdueLoans(patronId) : system_.getAllOverdueLoans();
+    for (const auto& loan : found) {
+        out_ << loan.patronId << '\t' << loan.itemId << '\t' << loan.title << '\t'
+             << loan.dueDate.toString("yyyy-MM-dd").toStdString() << '\t' << loan.daysOverdue << '\n';
+    }
+    return true;
+}
+
+bool CommandInterpreter::user(const std::vector<std::string>& args) {
+    const std::string name = joinFrom(args, 1);
+    auto found = system_.findUserByName(name);
+    if (!found) return fail("no user named '" + name + "'");
+    out_ << found->id() << '\t' << roleName(found->role()) << '\t' << found->name() << '\n';
+    return true;
+}
+
+bool CommandInterpreter::help(const std::vector<std::string>&) {
+    printUsage(out_);
+    return true;
+}
+
+// --- Helpers ---
+
+bool CommandInterpreter::fail(const std::string& message) {
+    err_ << "error: " << message << '\n';
+    return false;
+}
+
+bool CommandInterpreter::parseInt(const std::string& text, const char* what, int& value) {
+    const char* end = text.data() + text.size();
+    const auto result = std::from_chars(text.data(), end, value);
+    if (result.ec != std::errc() || result.ptr != end) {
+        return fail(std::string(what) + " must be a number, got '" + text + "'");
+    }
+    return true;
+}
+
+void CommandInterpreter::printItem(const ItemView& item) {
+    out_ << item.id() << '\t' << item.typeName() << '\t' << statusName(item.status()) << '\t'
+         << item.title() << '\t' << item.creator() << '\t' << item.publicationYear() << '\n';
+}
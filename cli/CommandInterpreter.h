@@ -0,0 +1,63 @@
+#pragma once
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "models/LibrarySystem.h"
+
+// Runs hinlibs-cli commands against a LibrarySystem. A command is a list of words,
+// e.g. {"borrow", "2", "14"}; results go to out, one tab-separated record per line,
+// and failures to err as "error: ...".
+class CommandInterpreter {
+public:
+    CommandInterpreter(hinlibs::LibrarySystem& system, std::ostream& out, std::ostream& err);
+
+    // Returns false if the command is unknown, malformed or refused by the library.
+    bool execute(const std::vector<std::string>& args);
+
+    // Executes one command per line. Blank lines and lines starting with '#' are skipped.
+    // Returns the number of commands that failed.
+    int runScript(std::istream& in);
+
+    // Splits a script line on whitespace; "double quotes" group words, \" escapes a quote.
+    static std::vector<std::string> tokenize(const std::string& line);
+
+    void printUsage(std::ostream& os) const;
+
+private:
+    struct Command {
+        const char* name;
+        const char* usage;
+        std::size_t minArgs;
+        bool (CommandInterpreter::*run)(const std::vector<std::string>& args);
+    };
+    static const std::vector<Command>& commands();
+
+    bool borrow(const std::vector<std::string>& args);
+    bool giveBack(const std::vector<std::string>& args);
+    bool hold(const std::vector<std::string>& args);
+    bool cancelHold(const std::vector<std::string>& args);
+    bool add(const std::vector<std::string>& args);
+    bool remove(const std::vector<std::string>& args);
+    bool importCatalogue(const std::vector<std::string>& args);
+    bool exportRecords(const std::vector<std::string>& args);
+    bool fines(const std::vector<std::string>& args);
+    bool item(const std::vector<std::string>& args);
+    bool search(const std::vector<std::string>& args);
+    bool facet(const std::vector<std::string>& args);
+    bool loans(const std::vector<std::string>& args);
+    bool holds(const std::vector<std::string>& args);
+    bool overdue(const std::vector<std::string>& args);
+    bool user(const std::vector<std::string>& args);
+    bool help(const std::vector<std::string>& args);
+
+    bool fail(const std::string& message);
+    bool parseInt(const std::string& text, const char* what, int& value);
+    void printItem(const hinlibs::ItemView& item);
+
+    static constexpr std::size_t FACET_ITEM_LIMIT = 1000;
+
+    hinlibs::LibrarySystem& system_;
+    std::ostream& out_;
+    std::ostream& err_;
+};
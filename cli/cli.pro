@@ -0,0 +1,21 @@
+QT = core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+TARGET = hinlibs-cli
+
+include(../models/models.pri)
+include(../db/db.pri)
+
+SOURCES += \
+    main.cpp \
+    CommandInterpreter.cpp
+
+HEADERS += \
+    CommandInterpreter.h
+
+INCLUDEPATH += $$PWD
+
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
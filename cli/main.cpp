@@ -0,0 +1,44 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <iostream>
+
+#include "CommandInterpreter.h"
+
+// hinlibs-cli [--db PATH] [--profile NAME] [COMMAND ARGS...]
+// With a command, runs it and exits; without one, runs a script of commands from stdin.
+// Exit status is 0 if every command succeeded and 1 otherwise.
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("hinlibs-cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless front end for the HinLIBS library system. "
+                                     "Without a command, reads one command per line from stdin.");
+    parser.setOptionsAfterPositionalArgumentsMode(QCommandLineParser::ParseAsPositionalArguments);
+    parser.addHelpOption();
+    QCommandLineOption dbOption("db", "SQLite database file.", "path", hinlibs::LibrarySystem::DEFAULT_DATABASE_PATH);
+    QCommandLineOption profileOption("profile", "Database profile (compat, balanced, durable, fast).", "name");
+    parser.addOption(dbOption);
+    parser.addOption(profileOption);
+    parser.addPositionalArgument("command", "Command and its arguments; see 'help'.", "[command args...]");
+    parser.process(app);
+
+    if (parser.isSet(profileOption)) {
+        // Set through the environment so db/hinlibs.ini overrides still apply on top.
+        qputenv("HINLIBS_DB_PROFILE", parser.value(profileOption).toUtf8());
+    }
+
+    hinlibs::LibrarySystem system(parser.value(dbOption));
+    CommandInterpreter interpreter(system, std::cout, std::cerr);
+
+    const QStringList positional = parser.positionalArguments();
+    if (positional.isEmpty()) {
+        return interpreter.runScript(std::cin) == 0 ? 0 : 1;
+    }
+
+    std::vector<std::string> args;
+    for (const QString& arg : positional) {
+        args.push_back(arg.toStdString());
+    }
+    return interpreter.execute(args) ? 0 : 1;
+}
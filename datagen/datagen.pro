@@ -0,0 +1,11 @@
+QT = core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+TARGET = hinlibs-datagen
+
+include(../models/models.pri)
+include(../db/db.pri)
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,16 @@
+# Copies the SQLite database next to the application's build output so the
+# relative path db/hinlibs.sqlite3 resolves when it is run from the build directory.
+
+DB_SOURCE_FILE = db/hinlibs.sqlite3
+
+COPIED_SOURCE_INTO_BUILD_DESTINATION = $$OUT_PWD/$$DB_SOURCE_FILE
+
+NEW_DB_DIR = $$dirname(COPIED_SOURCE_INTO_BUILD_DESTINATION)
+
+!exists($$NEW_DB_DIR) {
+    system(mkdir -p $$NEW_DB_DIR)
+}
+
+!exists($$COPIED_SOURCE_INTO_BUILD_DESTINATION) {
+    system(cp -f $$PWD/hinlibs.sqlite3 $$COPIED_SOURCE_INTO_BUILD_DESTINATION)
+}
@@ -1,10 +1,45 @@
 #include "CatalogueModel.h"
 
-CatalogueModel::CatalogueModel(std::shared_ptr<hinlibs::LibrarySystem> system, QObject* parent)
-    : QAbstractTableModel(parent), system_(std::move(system)) {
+#include <QtConcurrent>
+#include <algorithm>
+#include <array>
+
+namespace {
+
+const QString& cachedText(QString& cache, std::string_view text) {
+    if (cache.isNull()) cache = QString::fromUtf8(text.data(), static_cast<int>(text.size()));
+    return cache;
+}
+
+// One shared QString per kind and per status, so these columns never convert per row.
+const QString& typeNameText(const hinlibs::ItemView& item) {
+    static std::array<QString, 5> names;
+    return cachedText(names[static_cast<std::size_t>(item.catalogueKind())], item.typeName());
+}
+
+const QString& availabilityText(hinlibs::ItemStatus status) {
+    static const QString available("Available");
+    static const QString checkedOut("Checked Out");
+    return status == hinlibs::ItemStatus::Available ? available : checkedOut;
+}
+
+} // namespace
+
+CatalogueModel::CatalogueModel(std::shared_ptr<hinlibs::AsyncLibrarySystem> library, QObject* parent)
+    : QAbstractTableModel(parent), library_(std::move(library)), system_(library_->system()) {
+    // Changes are reported on the database thread; apply them on ours.
+    listenerId_ = system_->addItemChangeListener(
+        [this](hinlibs::LibrarySystem::ItemChange change, int itemId) {
+            QMetaObject::invokeMethod(this, [this, change, itemId]() { onItemChanged(change, itemId); },
+                                      Qt::QueuedConnection);
+        });
     refresh();
 }
 
+CatalogueModel::~CatalogueModel() {
+    system_->removeItemChangeListener(listenerId_);
+}
+
 int CatalogueModel::rowCount(const QModelIndex& parent) const {
     if (parent.isValid()) return 0;
     return static_cast<int>(rows_.size());
@@ -14,11 +49,11 @@ QVariant CatalogueModel::data(const QModelIndex& index, int role) const {
     if (!index.isValid() || role != Qt::DisplayRole) return {};
     const auto& r = rows_.at(index.row());
     switch (index.column()) {
-        case 0: return r.id;
-        case 1: return r.title;
-        case 2: return r.creator;
-        case 3: return r.typeName;
-        case 4: return r.availability;
+        case 0: return r.item.id();
+        case 1: return cachedText(r.title, r.item.title());
+        case 2: return cachedText(r.creator, r.item.creator());
+        case 3: return typeNameText(r.item);
+        case 4: return availabilityText(r.item.status());
     }
     return {};
 }
@@ -35,24 +70,218 @@ QVariant CatalogueModel::headerData(int section, Qt::Orientation orientation, in
     return {};
 }
 
+bool CatalogueModel::canFetchMore(const QModelIndex& parent) const {
+    if (parent.isValid() || exhausted_ || pagePending_) return false;
+    return searchText_.isEmpty() || !suggestions_;
+}
+
+void CatalogueModel::fetchMore(const QModelIndex& parent) {
+    if (!canFetchMore(parent)) return;
+    if (!searchText_.isEmpty()) {
+        fetchSearchPage();
+        return;
+    }
+    // A rare filter can walk most of the catalogue to fill a page, so that runs on a reader.
+    if (kindFilter_ || statusFilter_) {
+        fetchFilteredPage();
+        return;
+    }
+
+    const auto page = system_->itemsAfter(lastLoadedId_, PAGE_SIZE);
+    if (page.size() < static_cast<std::size_t>(PAGE_SIZE)) exhausted_ = true;
+    appendPage(page);
+}
+
+// Asks a reader thread for the next PAGE_SIZE items that pass the filters and appends them when they arrive.
+void CatalogueModel::fetchFilteredPage() {
+    pagePending_ = true;
+    const quint64 generation = searchGeneration_->load();
+    hinlibs::whenReady(this, library_->itemsAfter(lastLoadedId_, PAGE_SIZE, kindFilter_, statusFilter_),
+                       [this, generation](const std::vector<hinlibs::ItemView>& items) {
+        if (generation != searchGeneration_->load()) return;   // filters changed while it ran
+        pagePending_ = false;
+        if (items.size() < static_cast<std::size_t>(PAGE_SIZE)) exhausted_ = true;
+        appendPage(items);
+    });
+}
+
+// Asks the database thread for the next SEARCH_PAGE_SIZE results and appends them when they arrive.
+void CatalogueModel::fetchSearchPage() {
+    hinlibs::LibrarySystem::CatalogueSearch search;
+    search.text = searchText_.toStdString();
+    if (kindFilter_) search.kind = hinlibs::catalogueKindName(*kindFilter_);
+    search.status = statusFilter_;
+    search.limit = SEARCH_PAGE_SIZE;
+    search.offset = searchOffset_;
+    searchOffset_ += SEARCH_PAGE_SIZE;
+    pagePending_ = true;
+
+    const quint64 generation = searchGeneration_->load();
+    hinlibs::whenReady(this, library_->searchCatalogue(search),
+                       [this, generation](const std::vector<hinlibs::ItemView>& items) {
+        if (generation != searchGeneration_->load()) return;   // superseded while the query ran
+        pagePending_ = false;
+        if (items.size() < static_cast<std::size_t>(SEARCH_PAGE_SIZE)) exhausted_ = true;
+        appendPage(items);
+    });
+}
+
+void CatalogueModel::appendPage(const std::vector<hinlibs::ItemView>& items) {
+    if (items.empty()) return;
+    if (searchText_.isEmpty()) lastLoadedId_ = items.back().id();
+
+    const int first = static_cast<int>(rows_.size());
+    beginInsertRows(QModelIndex(), first, first + static_cast<int>(items.size()) - 1);
+    for (const auto& item : items) appendRow(item);
+    endInsertRows();
+}
+
 void CatalogueModel::refresh() {
+    ++*searchGeneration_;
+
     beginResetModel();
     rows_.clear();
-    const auto& items = system_->allItems();
-    rows_.reserve(items.size());
-    for (const auto& it : items) {
-        rows_.push_back({
-            it->id(),
-            QString::fromStdString(it->title()),
-            QString::fromStdString(it->creator()),
-            QString::fromStdString(it->typeName()),
-            it->status() == hinlibs::ItemStatus::Available ? "Available" : "Checked Out"
-        });
+    lastLoadedId_ = 0;
+    searchOffset_ = 0;
+    pagePending_ = false;
+    suggestions_ = false;
+    exhausted_ = false;
+    endResetModel();
+    // The view pulls further pages through canFetchMore/fetchMore; load the first one now.
+    fetchMore(QModelIndex());
+}
+
+void CatalogueModel::setSearchText(const QString& text) {
+    searchText_ = text.trimmed();
+    refresh();
+}
+
+void CatalogueModel::setFilters(std::optional<hinlibs::CatalogueKind> kind, std::optional<hinlibs::ItemStatus> status) {
+    kindFilter_ = kind;
+    statusFilter_ = status;
+    refresh();
+}
+
+std::optional<hinlibs::CatalogueKind> CatalogueModel::kindFilterAt(int index) {
+    if (index <= 0 || index > static_cast<int>(hinlibs::CatalogueKind::VideoGame) + 1) return std::nullopt;
+    return static_cast<hinlibs::CatalogueKind>(index - 1);
+}
+
+std::optional<hinlibs::ItemStatus> CatalogueModel::statusFilterAt(int index) {
+    switch (index) {
+    case 1: return hinlibs::ItemStatus::Available;
+    case 2: return hinlibs::ItemStatus::CheckedOut;
+    }
+    return std::nullopt;
+}
+
+bool CatalogueModel::matchesFilters(const hinlibs::ItemView& item) const {
+    return (!kindFilter_ || item.catalogueKind() == *kindFilter_)
+        && (!statusFilter_ || item.status() == *statusFilter_);
+}
+
+void CatalogueModel::searchAsYouType(const QString& text) {
+    const QString trimmed = text.trimmed();
+    if (trimmed.isEmpty()) {
+        setSearchText(trimmed);
+        return;
+    }
+
+    const quint64 generation = ++*searchGeneration_;
+    auto latest = searchGeneration_;
+    auto system = system_;
+    const std::string query = trimmed.toStdString();
+
+    auto future = QtConcurrent::run([system, latest, generation, query]() {
+        return system->suggestItemIds(query, SEARCH_PAGE_SIZE,
+                                      [&latest, generation]() { return latest->load() != generation; });
+    });
+    hinlibs::whenReady(this, future, [this, generation, trimmed](const std::vector<int>& itemIds) {
+        if (generation != searchGeneration_->load()) return;   // a newer keystroke won
+        searchText_ = trimmed;
+        suggestions_ = true;
+        showItemIds(itemIds);
+    });
+}
+
+void CatalogueModel::showItemIds(const std::vector<int>& itemIds) {
+    beginResetModel();
+    rows_.clear();
+    rows_.reserve(itemIds.size());
+    for (int itemId : itemIds) {
+        auto item = system_->getItemById(itemId);
+        if (item && matchesFilters(item)) appendRow(item);
     }
     endResetModel();
 }
 
+void CatalogueModel::appendRow(const hinlibs::ItemView& item) {
+    rows_.push_back(Row{ item, QString(), QString() });
+}
+
+int CatalogueModel::rowForItemId(int itemId) const {
+    if (searchText_.isEmpty()) {
+        // Paged browsing loads rows in id order.
+        auto it = std::lower_bound(rows_.begin(), rows_.end(), itemId,
+                                   [](const Row& r, int id) { return r.item.id() < id; });
+        if (it != rows_.end() && it->item.id() == itemId) return static_cast<int>(it - rows_.begin());
+        return -1;
+    }
+    auto it = std::find_if(rows_.begin(), rows_.end(), [itemId](const Row& r) { return r.item.id() == itemId; });
+    return it == rows_.end() ? -1 : static_cast<int>(it - rows_.begin());
+}
+
+// Applies one catalogue change to the loaded rows so the view keeps its selection and scroll position.
+void CatalogueModel::onItemChanged(hinlibs::LibrarySystem::ItemChange change, int itemId) {
+    using Change = hinlibs::LibrarySystem::ItemChange;
+
+    if (change == Change::Reloaded) {
+        refresh();
+        return;
+    }
+
+    const int row = rowForItemId(itemId);
+    switch (change) {
+    case Change::Updated: {
+        if (row < 0) return;
+        auto item = system_->getItemById(itemId);
+        if (!item) return;
+        if (!matchesFilters(item)) {
+            // e.g. a borrowed item under an Available filter
+            beginRemoveRows(QModelIndex(), row, row);
+            rows_.erase(rows_.begin() + row);
+            endRemoveRows();
+            return;
+        }
+        rows_[row] = Row{ item, QString(), QString() };
+        emit dataChanged(index(row, 0), index(row, columnCount() - 1), {Qt::DisplayRole});
+        break;
+    }
+    case Change::Removed:
+        if (row < 0) return;
+        beginRemoveRows(QModelIndex(), row, row);
+        rows_.erase(rows_.begin() + row);
+        endRemoveRows();
+        break;
+    case Change::Added: {
+        // New ids are the largest, so they belong at the end once every page is loaded;
+        // until then the next fetchMore picks them up. Search results are left as they are.
+        if (!searchText_.isEmpty() || !exhausted_ || row >= 0) return;
+        auto item = system_->getItemById(itemId);
+        if (!item || !matchesFilters(item)) return;
+        const int last = static_cast<int>(rows_.size());
+        beginInsertRows(QModelIndex(), last, last);
+        appendRow(item);
+        endInsertRows();
+        lastLoadedId_ = itemId;
+        break;
+    }
+    case Change::Reloaded:
+        break;
+    }
+}
+
 int CatalogueModel::itemIdAtRow(int row) const {
     if (row < 0 || row >= static_cast<int>(rows_.size())) return -1;
-    return rows_[row].id;
+    return rows_[row].item.id();
 }
@@ -2,30 +2,78 @@
 #include <QAbstractTableModel>
 #include <vector>
 #include <memory>
-#include "models/LibrarySystem.h"
+#include <atomic>
+#include <optional>
+#include "models/AsyncLibrarySystem.h"
 
 class CatalogueModel : public QAbstractTableModel {
     Q_OBJECT
 public:
-    explicit CatalogueModel(std::shared_ptr<hinlibs::LibrarySystem> system, QObject* parent = nullptr);
+    explicit CatalogueModel(std::shared_ptr<hinlibs::AsyncLibrarySystem> library, QObject* parent = nullptr);
+    ~CatalogueModel() override;
 
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
     int columnCount(const QModelIndex& parent = QModelIndex()) const override { Q_UNUSED(parent); return 5; }
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
     QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
 
+    // The catalogue, and the results of a submitted search, are loaded a page at a time
+    // as the view scrolls. Search-as-you-type suggestions come in one batch.
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    static constexpr int PAGE_SIZE = 256;
+
     void refresh();
 
+    // Empty text shows the whole catalogue; otherwise rows come from LibrarySystem::searchCatalogue,
+    // which runs on the database thread and replaces the rows when it finishes.
+    void setSearchText(const QString& text);
+
+    // Shows only items of this kind and status (nullopt for any), in every mode.
+    void setFilters(std::optional<hinlibs::CatalogueKind> kind, std::optional<hinlibs::ItemStatus> status);
+    // Filter combo box entries, in the order the windows list them; index 0 means any.
+    static std::optional<hinlibs::CatalogueKind> kindFilterAt(int index);
+    static std::optional<hinlibs::ItemStatus> statusFilterAt(int index);
+
+    // Per-keystroke search over the in-memory index, run off the GUI thread.
+    // A newer call (or setSearchText/refresh) supersedes any search still in flight.
+    void searchAsYouType(const QString& text);
+
     int itemIdAtRow(int row) const;
 
 private:
+    // Rows hold the item's view; title and creator become QStrings the first time data()
+    // asks for them, so only rows the view paints are ever converted.
     struct Row {
-        int id;
-        QString title;
-        QString creator;
-        QString typeName;
-        QString availability;
+        hinlibs::ItemView item;
+        mutable QString title;      // null until painted
+        mutable QString creator;
     };
-    std::shared_ptr<hinlibs::LibrarySystem> system_;
+    std::shared_ptr<hinlibs::AsyncLibrarySystem> library_;
+    std::shared_ptr<hinlibs::LibrarySystem> system_;     // in-memory lookups only
     std::vector<Row> rows_;
+    QString searchText_;
+    std::optional<hinlibs::CatalogueKind> kindFilter_;
+    std::optional<hinlibs::ItemStatus> statusFilter_;
+    int lastLoadedId_{0};       // keyset cursor for the next catalogue page
+    int searchOffset_{0};       // search results requested so far, for the next search page
+    bool pagePending_{false};   // a filtered or search page is on its way from a reader thread
+    bool suggestions_{false};   // rows are search-as-you-type suggestions, not a paged search
+    bool exhausted_{false};
+    // Bumped on every new search; workers compare against it to notice they are stale.
+    std::shared_ptr<std::atomic<quint64>> searchGeneration_ = std::make_shared<std::atomic<quint64>>(0);
+
+    static constexpr int SEARCH_PAGE_SIZE = 200;
+
+    int listenerId_{0};
+
+    bool matchesFilters(const hinlibs::ItemView& item) const;
+    void fetchFilteredPage();
+    void fetchSearchPage();
+    void appendPage(const std::vector<hinlibs::ItemView>& items);
+    void appendRow(const hinlibs::ItemView& item);
+    int rowForItemId(int itemId) const;
+    void onItemChanged(hinlibs::LibrarySystem::ItemChange change, int itemId);
+    void showItemIds(const std::vector<int>& itemIds);
 };
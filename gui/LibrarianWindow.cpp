@@ -5,32 +5,54 @@
 #include "LoginWindow.h"
 #include "AddItemDialog.h"
 
+#include <QComboBox>
 #include <QMessageBox>
 #include <QStandardItemModel>
 #include <QAbstractItemView>
 #include <QHeaderView>
 
-LibrarianWindow::LibrarianWindow(std::shared_ptr<hinlibs::LibrarySystem> system,
+namespace {
+
+QString standingText(hinlibs::LibrarySystem::LoanStanding standing) {
+    switch (standing) {
+    case hinlibs::LibrarySystem::LoanStanding::Overdue: return QStringLiteral("Overdue");
+    case hinlibs::LibrarySystem::LoanStanding::DueSoon: return QStringLiteral("Due soon");
+    case hinlibs::LibrarySystem::LoanStanding::Current: break;
+    }
+    return QString();
+}
+
+} // namespace
+
+LibrarianWindow::LibrarianWindow(std::shared_ptr<hinlibs::AsyncLibrarySystem> library,
                                  std::shared_ptr<hinlibs::User> librarian,
                                  QWidget* parent)
     : QMainWindow(parent),
       ui(new Ui::LibrarianWindow),
-      system_(std::move(system)),
+      library_(std::move(library)),
       librarian_(std::move(librarian)) {
 
     ui->setupUi(this);
 
     // ========== Catalogue Tab ==========
-    catalogueModel_ = new CatalogueModel(system_, this);
+    catalogueModel_ = new CatalogueModel(library_, this);
     ui->tableCatalogue->setModel(catalogueModel_);
     ui->tableCatalogue->setSelectionBehavior(QAbstractItemView::SelectRows);
     ui->tableCatalogue->setSelectionMode(QAbstractItemView::SingleSelection);
     ui->tableCatalogue->setEditTriggers(QAbstractItemView::NoEditTriggers);
     ui->tableCatalogue->horizontalHeader()->setStretchLastSection(true);
+    // Size columns from the first page only; the model loads further rows lazily.
+    ui->tableCatalogue->horizontalHeader()->setResizeContentsPrecision(CatalogueModel::PAGE_SIZE);
 
     connect(ui->btnAddItem, &QPushButton::clicked, this, &LibrarianWindow::onAddItem);
     connect(ui->btnRemoveItem, &QPushButton::clicked, this, &LibrarianWindow::onRemoveItem);
     connect(ui->btnRefreshCatalogue, &QPushButton::clicked, this, &LibrarianWindow::onRefreshCatalogue);
+    connect(ui->btnSearchCatalogue, &QPushButton::clicked, this, &LibrarianWindow::onSearchCatalogue);
+    connect(ui->lineCatalogueSearch, &QLineEdit::returnPressed, this, &LibrarianWindow::onSearchCatalogue);
+    connect(ui->comboCatalogueKind, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &LibrarianWindow::onCatalogueFilterChanged);
+    connect(ui->comboCatalogueStatus, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &LibrarianWindow::onCatalogueFilterChanged);
 
     // ========== Return-On-Behalf Tab ==========
     connect(ui->btnSearchPatron, &QPushButton::clicked, this, &LibrarianWindow::onSearchPatron);
@@ -51,6 +73,16 @@ void LibrarianWindow::onRefreshCatalogue() {
     ui->tableCatalogue->resizeColumnsToContents();
 }
 
+void LibrarianWindow::onSearchCatalogue() {
+    catalogueModel_->setSearchText(ui->lineCatalogueSearch->text());
+    ui->tableCatalogue->resizeColumnsToContents();
+}
+
+void LibrarianWindow::onCatalogueFilterChanged() {
+    catalogueModel_->setFilters(CatalogueModel::kindFilterAt(ui->comboCatalogueKind->currentIndex()),
+                                CatalogueModel::statusFilterAt(ui->comboCatalogueStatus->currentIndex()));
+}
+
 void LibrarianWindow::onAddItem() {
     AddItemDialog dlg(this);
     if (dlg.exec() != QDialog::Accepted) {
@@ -58,14 +90,17 @@ void LibrarianWindow::onAddItem() {
     }
 
     auto data = dlg.itemData();
-    if (!system_->addItemToCatalogue(librarian_->id(), data)) {
-        QMessageBox::warning(this, "Add Item Failed",
-                             "The item could not be added to the catalogue.");
-        return;
-    }
-
-    onRefreshCatalogue();
-    QMessageBox::information(this, "Success", "Item added to catalogue.");
+    setCatalogueBusy(true);
+    hinlibs::whenReady(this, library_->addItemToCatalogue(librarian_->id(), data), [this](bool added) {
+        setCatalogueBusy(false);
+        if (!added) {
+            QMessageBox::warning(this, "Add Item Failed",
+                                 "The item could not be added to the catalogue.");
+            return;
+        }
+
+        QMessageBox::information(this, "Success", "Item added to catalogue.");
+    });
 }
 
 void LibrarianWindow::onRemoveItem() {
@@ -78,15 +113,23 @@ void LibrarianWindow::onRemoveItem() {
     const int row = sel.first().row();
     const int itemId = catalogueModel_->itemIdAtRow(row);
 
-    if (!system_->removeItemFromCatalogue(librarian_->id(), itemId)) {
-        QMessageBox::warning(this, "Remove Failed",
-                             "Item could not be removed.\n"
-                             "Make sure it is Available (not checked out).");
-        return;
-    }
+    setCatalogueBusy(true);
+    hinlibs::whenReady(this, library_->removeItemFromCatalogue(librarian_->id(), itemId), [this](bool removed) {
+        setCatalogueBusy(false);
+        if (!removed) {
+            QMessageBox::warning(this, "Remove Failed",
+                                 "Item could not be removed.\n"
+                                 "Make sure it is Available (not checked out).");
+            return;
+        }
+
+        QMessageBox::information(this, "Success", "Item removed successfully.");
+    });
+}
 
-    onRefreshCatalogue();
-    QMessageBox::information(this, "Success", "Item removed successfully.");
+void LibrarianWindow::setCatalogueBusy(bool busy) {
+    ui->btnAddItem->setEnabled(!busy);
+    ui->btnRemoveItem->setEnabled(!busy);
 }
 
 
@@ -99,39 +142,48 @@ void LibrarianWindow::onSearchPatron() {
         return;
     }
 
-    auto user = system_->LibrarianFindPatronByName(name);
-    if (!user) {
-        QMessageBox::warning(this, "Search Patron", "No patron found with that name.");
-        selectedPatron_.reset();
-        return;
-    }
-
-    selectedPatron_ = std::static_pointer_cast<hinlibs::Patron>(user);
-    populateLoansTableForCurrentPatron();
+    setReturnBusy(true);
+    hinlibs::whenReady(this, library_->librarianFindPatronByName(name),
+                       [this](const std::shared_ptr<hinlibs::User>& user) {
+        setReturnBusy(false);
+        if (!user) {
+            QMessageBox::warning(this, "Search Patron", "No patron found with that name.");
+            selectedPatron_.reset();
+            return;
+        }
+
+        selectedPatron_ = std::static_pointer_cast<hinlibs::Patron>(user);
+        populateLoansTableForCurrentPatron();
+    });
 }
 
 void LibrarianWindow::populateLoansTableForCurrentPatron() {
     if (!selectedPatron_) return;
 
-    auto loans = system_->getAccountLoans(selectedPatron_->id());
-
-    auto* loansModel = new QStandardItemModel(this);
-    loansModel->setHorizontalHeaderLabels({"Item ID", "Title", "Due Date", "Days Remaining"});
-
-    for (const auto& l : loans) {
-        QList<QStandardItem*> row;
-        row << new QStandardItem(QString::number(l.itemId));
-        row << new QStandardItem(QString::fromStdString(l.title));
-        row << new QStandardItem(l.dueDate.toString("yyyy-MM-dd"));
-        row << new QStandardItem(QString::number(l.daysRemaining));
-        loansModel->appendRow(row);
-    }
-
-    ui->tableLoans->setModel(loansModel);
-    ui->tableLoans->setSelectionBehavior(QAbstractItemView::SelectRows);
-    ui->tableLoans->setSelectionMode(QAbstractItemView::SingleSelection);
-    ui->tableLoans->setEditTriggers(QAbstractItemView::NoEditTriggers);
-    ui->tableLoans->horizontalHeader()->setStretchLastSection(true);
+    setReturnBusy(true);
+    hinlibs::whenReady(this, library_->getAccountLoans(selectedPatron_->id()),
+                       [this](const std::vector<hinlibs::LibrarySystem::AccountLoan>& loans) {
+        setReturnBusy(false);
+
+        auto* loansModel = new QStandardItemModel(this);
+        loansModel->setHorizontalHeaderLabels({"Item ID", "Title", "Due Date", "Days Remaining", "Standing"});
+
+        for (const auto& l : loans) {
+            QList<QStandardItem*> row;
+            row << new QStandardItem(QString::number(l.itemId));
+            row << new QStandardItem(QString::fromStdString(l.title));
+            row << new QStandardItem(l.dueDate.toString("yyyy-MM-dd"));
+            row << new QStandardItem(QString::number(l.daysRemaining));
+            row << new QStandardItem(standingText(l.standing));
+            loansModel->appendRow(row);
+        }
+
+        ui->tableLoans->setModel(loansModel);
+        ui->tableLoans->setSelectionBehavior(QAbstractItemView::SelectRows);
+        ui->tableLoans->setSelectionMode(QAbstractItemView::SingleSelection);
+        ui->tableLoans->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        ui->tableLoans->horizontalHeader()->setStretchLastSection(true);
+    });
 }
 
 void LibrarianWindow::onReturnOnBehalf() {
@@ -149,16 +201,24 @@ void LibrarianWindow::onReturnOnBehalf() {
     const int row = sel.first().row();
     const int itemId = ui->tableLoans->model()->index(row, 0).data().toInt();
 
-    if (!system_->returnItem(selectedPatron_->id(), itemId)) {
-        QMessageBox::warning(this, "Return Failed",
-                             "Unable to return this item.\n"
-                             "Make sure the patron actually has it.");
-        return;
-    }
+    setReturnBusy(true);
+    hinlibs::whenReady(this, library_->returnItem(selectedPatron_->id(), itemId), [this](bool returned) {
+        setReturnBusy(false);
+        if (!returned) {
+            QMessageBox::warning(this, "Return Failed",
+                                 "Unable to return this item.\n"
+                                 "Make sure the patron actually has it.");
+            return;
+        }
+
+        populateLoansTableForCurrentPatron();
+        QMessageBox::information(this, "Success", "Item returned successfully.");
+    });
+}
 
-    populateLoansTableForCurrentPatron();
-    onRefreshCatalogue();
-    QMessageBox::information(this, "Success", "Item returned successfully.");
+void LibrarianWindow::setReturnBusy(bool busy) {
+    ui->btnSearchPatron->setEnabled(!busy);
+    ui->btnReturnOnBehalf->setEnabled(!busy);
 }
 
 
@@ -167,7 +227,7 @@ void LibrarianWindow::onReturnOnBehalf() {
 
 void LibrarianWindow::onLogout() {
     close();
-    auto* login = new LoginWindow(system_, nullptr);
+    auto* login = new LoginWindow(library_, nullptr);
     login->setAttribute(Qt::WA_DeleteOnClose);
     login->show();
 }
@@ -2,7 +2,7 @@
 
 #include <QMainWindow>
 #include <memory>
-#include "models/LibrarySystem.h"
+#include "models/AsyncLibrarySystem.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class LibrarianWindow; }
@@ -13,7 +13,7 @@ class CatalogueModel;
 class LibrarianWindow : public QMainWindow {
     Q_OBJECT
 public:
-    LibrarianWindow(std::shared_ptr<hinlibs::LibrarySystem> system,
+    LibrarianWindow(std::shared_ptr<hinlibs::AsyncLibrarySystem> library,
                     std::shared_ptr<hinlibs::User> librarian,
                     QWidget* parent = nullptr);
     ~LibrarianWindow();
@@ -23,6 +23,8 @@ private slots:
     void onAddItem();
     void onRemoveItem();
     void onRefreshCatalogue();
+    void onSearchCatalogue();
+    void onCatalogueFilterChanged();
 
     // Return-on-behalf tab
     void onSearchPatron();
@@ -31,9 +33,12 @@ private slots:
 
 private:
     void populateLoansTableForCurrentPatron();
+    // Disable the buttons of a tab while its database request is in flight.
+    void setCatalogueBusy(bool busy);
+    void setReturnBusy(bool busy);
 
     std::unique_ptr<Ui::LibrarianWindow> ui;
-    std::shared_ptr<hinlibs::LibrarySystem> system_;
+    std::shared_ptr<hinlibs::AsyncLibrarySystem> library_;
     std::shared_ptr<hinlibs::User> librarian_;
 
     CatalogueModel* catalogueModel_{nullptr};
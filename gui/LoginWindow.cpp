@@ -7,10 +7,10 @@
 #include <QLineEdit>
 #include <QMessageBox>
 
-LoginWindow::LoginWindow(std::shared_ptr<hinlibs::LibrarySystem> system, QWidget* parent)
+LoginWindow::LoginWindow(std::shared_ptr<hinlibs::AsyncLibrarySystem> library, QWidget* parent)
     : QMainWindow(parent),
       ui(new Ui::LoginWindow),
-      system_(std::move(system)) {
+      library_(std::move(library)) {
     ui->setupUi(this);
 
     // Match the names in LoginWindow.ui (btnLogin, lineUsername)
@@ -26,7 +26,8 @@ void LoginWindow::onLogin() {
         return;
     }
 
-    auto user = system_->findUserByName(name);
+    // Users are cached in memory, so this lookup never waits on the database.
+    auto user = library_->system()->findUserByName(name);
     if (!user) {
         QMessageBox::warning(this, "Login Failed", "User not found.");
         return;
@@ -37,14 +38,14 @@ void LoginWindow::onLogin() {
     switch (user->role()) {
     case Role::Patron: {
         auto patron = std::static_pointer_cast<hinlibs::Patron>(user);
-        auto* w = new PatronWindow(system_, patron, nullptr);
+        auto* w = new PatronWindow(library_, patron, nullptr);
         w->setAttribute(Qt::WA_DeleteOnClose);
         w->show();
         close(); // clear previous user context
         break;
     }
     case Role::Librarian: {
-        auto* w = new LibrarianWindow(system_, user, nullptr);
+        auto* w = new LibrarianWindow(library_, user, nullptr);
         w->setAttribute(Qt::WA_DeleteOnClose);
         w->show();
         close();
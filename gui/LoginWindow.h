@@ -1,7 +1,7 @@
 #pragma once
 #include <QMainWindow>
 #include <memory>
-#include "LibrarySystem.h"
+#include "AsyncLibrarySystem.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class LoginWindow; }
@@ -10,7 +10,7 @@ QT_END_NAMESPACE
 class LoginWindow : public QMainWindow {
     Q_OBJECT
 public:
-    explicit LoginWindow(std::shared_ptr<hinlibs::LibrarySystem> system,
+    explicit LoginWindow(std::shared_ptr<hinlibs::AsyncLibrarySystem> library,
                          QWidget* parent = nullptr);
     ~LoginWindow();
 
@@ -19,5 +19,5 @@ private slots:
 
 private:
     std::unique_ptr<Ui::LoginWindow>       ui;
-    std::shared_ptr<hinlibs::LibrarySystem> system_;
+    std::shared_ptr<hinlibs::AsyncLibrarySystem> library_;
 };
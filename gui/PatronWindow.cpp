@@ -5,35 +5,47 @@
 
 
 #include <QPushButton>
+#include <QLineEdit>
+#include <QComboBox>
 #include <QAbstractItemView>
 #include <QHeaderView>
 #include <QTableView>
 #include <QMessageBox>
 #include <QStandardItemModel>
 #include <QItemSelectionModel>
+#include <algorithm>
 
 
 
-PatronWindow::PatronWindow(std::shared_ptr<hinlibs::LibrarySystem> system,
+PatronWindow::PatronWindow(std::shared_ptr<hinlibs::AsyncLibrarySystem> library,
                            std::shared_ptr<hinlibs::Patron> patron,
                            QWidget* parent)
     : QMainWindow(parent),
       ui(new Ui::PatronWindow),
-      system_(std::move(system)),
+      library_(std::move(library)),
       patron_(std::move(patron)) {
     ui->setupUi(this);
 
     // --- Browse tab ---
-    catalogueModel_ = new CatalogueModel(system_, this);
+    catalogueModel_ = new CatalogueModel(library_, this);
     ui->browseTable->setModel(catalogueModel_);
     ui->browseTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     ui->browseTable->setSelectionMode(QAbstractItemView::SingleSelection);
     ui->browseTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     ui->browseTable->horizontalHeader()->setStretchLastSection(true);
+    // Size columns from the first page only; the model loads further rows lazily.
+    ui->browseTable->horizontalHeader()->setResizeContentsPrecision(CatalogueModel::PAGE_SIZE);
 
     connect(ui->btnBorrow, &QPushButton::clicked, this, &PatronWindow::onBorrow);
     connect(ui->btnPlaceHold, &QPushButton::clicked, this, &PatronWindow::onPlaceHold);
     connect(ui->btnRefreshBrowse, &QPushButton::clicked, this, &PatronWindow::onRefreshBrowse);
+    connect(ui->btnSearchBrowse, &QPushButton::clicked, this, &PatronWindow::onSearchBrowse);
+    connect(ui->lineBrowseSearch, &QLineEdit::returnPressed, this, &PatronWindow::onSearchBrowse);
+    connect(ui->lineBrowseSearch, &QLineEdit::textChanged, this, &PatronWindow::onBrowseTextChanged);
+    connect(ui->comboBrowseKind, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &PatronWindow::onBrowseFilterChanged);
+    connect(ui->comboBrowseStatus, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &PatronWindow::onBrowseFilterChanged);
 
     // --- Account tab ---
     connect(ui->btnReturn, &QPushButton::clicked, this, &PatronWindow::onReturn);
@@ -57,14 +69,20 @@ void PatronWindow::onBorrow() {
     const int itemId = catalogueModel_->itemIdAtRow(row);
     if (itemId < 0) return;
 
-    if (!system_->borrowItem(patron_->id(), itemId)) {
-        QMessageBox::warning(this, "Borrow Failed",
-                             "Cannot borrow this item (unavailable, queue fairness, or loan limit).");
-        return;
-    }
-//    system_->logUserActivity(patron_->id(), "Borrowed Item with Id " + std::to_string(itemId));
-    onRefreshBrowse();
-    populateAccountTables();
+    setBrowseBusy(true);
+    hinlibs::whenReady(this, library_->borrowItem(patron_->id(), itemId), [this](bool borrowed) {
+        setBrowseBusy(false);
+        if (!borrowed) {
+            QMessageBox::warning(this, "Borrow Failed",
+                                 "Cannot borrow this item (unavailable, queue fairness, or loan limit).");
+            return;
+        }
+        populateAccountTables();
+    });
+}
+
+namespace {
+enum class HoldOutcome { Placed, AlreadyLoaned, Refused };
 }
 
 void PatronWindow::onPlaceHold() {
@@ -74,19 +92,27 @@ void PatronWindow::onPlaceHold() {
     const int itemId = catalogueModel_->itemIdAtRow(row);
     if (itemId < 0) return;
 
-    if(system_->isLoanedBy(itemId, patron_->id())){
-        QMessageBox::warning(this, "Place Hold Failed",
-                             "You can not place a hold on an item you have already checked-out.");
-        return;
-    }
+    const int patronId = patron_->id();
+    auto future = library_->run([patronId, itemId](hinlibs::LibrarySystem& system) {
+        if (system.isLoanedBy(itemId, patronId)) return HoldOutcome::AlreadyLoaned;
+        return system.placeHold(patronId, itemId) ? HoldOutcome::Placed : HoldOutcome::Refused;
+    });
 
-    if (!system_->placeHold(patron_->id(), itemId)) {
-        QMessageBox::warning(this, "Place Hold Failed",
-                             "Holds are only allowed on checked-out items, and duplicates are not allowed.");
-        return;
-    }
-//    system_->logUserActivity(patron_->id(), "Placed hold on Item with Id " + std::to_string(itemId));
-    populateAccountTables();
+    setBrowseBusy(true);
+    hinlibs::whenReady(this, future, [this](HoldOutcome outcome) {
+        setBrowseBusy(false);
+        if (outcome == HoldOutcome::AlreadyLoaned) {
+            QMessageBox::warning(this, "Place Hold Failed",
+                                 "You can not place a hold on an item you have already checked-out.");
+            return;
+        }
+        if (outcome == HoldOutcome::Refused) {
+            QMessageBox::warning(this, "Place Hold Failed",
+                                 "Holds are only allowed on checked-out items, and duplicates are not allowed.");
+            return;
+        }
+        populateAccountTables();
+    });
 }
 
 void PatronWindow::onRefreshBrowse() {
@@ -94,6 +120,20 @@ void PatronWindow::onRefreshBrowse() {
     ui->browseTable->resizeColumnsToContents();
 }
 
+void PatronWindow::onSearchBrowse() {
+    catalogueModel_->setSearchText(ui->lineBrowseSearch->text());
+    ui->browseTable->resizeColumnsToContents();
+}
+
+void PatronWindow::onBrowseTextChanged(const QString& text) {
+    catalogueModel_->searchAsYouType(text);
+}
+
+void PatronWindow::onBrowseFilterChanged() {
+    catalogueModel_->setFilters(CatalogueModel::kindFilterAt(ui->comboBrowseKind->currentIndex()),
+                                CatalogueModel::statusFilterAt(ui->comboBrowseStatus->currentIndex()));
+}
+
 // --- Account actions ---
 
 void PatronWindow::onReturn() {
@@ -102,13 +142,15 @@ void PatronWindow::onReturn() {
     const int row = sel.first().row();
     const int itemId = ui->loansTable->model()->index(row, 0).data().toInt();
 
-    if (!system_->returnItem(patron_->id(), itemId)) {
-        QMessageBox::warning(this, "Return Failed", "This item is not loaned by you.");
-        return;
-    }
-//    system_->logUserActivity(patron_->id(), "Returned Item with Id " + std::to_string(itemId));
-    populateAccountTables();
-    onRefreshBrowse();
+    setAccountBusy(true);
+    hinlibs::whenReady(this, library_->returnItem(patron_->id(), itemId), [this](bool returned) {
+        setAccountBusy(false);
+        if (!returned) {
+            QMessageBox::warning(this, "Return Failed", "This item is not loaned by you.");
+            return;
+        }
+        populateAccountTables();
+    });
 }
 
 void PatronWindow::onCancelHold() {
@@ -117,19 +159,35 @@ void PatronWindow::onCancelHold() {
     const int row = sel.first().row();
     const int itemId = ui->holdsTable->model()->index(row, 0).data().toInt();
 
-    if (!system_->cancelHold(patron_->id(), itemId)) {
-        QMessageBox::warning(this, "Cancel Hold Failed", "Could not cancel this hold.");
-        return;
-    }
-//    system_->logUserActivity(patron_->id(), "Cancelled hold on Item with Id " + std::to_string(itemId));
-    populateAccountTables();
+    setAccountBusy(true);
+    hinlibs::whenReady(this, library_->cancelHold(patron_->id(), itemId), [this](bool cancelled) {
+        setAccountBusy(false);
+        if (!cancelled) {
+            QMessageBox::warning(this, "Cancel Hold Failed", "Could not cancel this hold.");
+            return;
+        }
+        populateAccountTables();
+    });
 }
 
 // --- Account population ---
 
 void PatronWindow::populateAccountTables() {
+    const int patronId = patron_->id();
+    auto future = library_->runRead([patronId](hinlibs::LibrarySystem& system) {
+        return std::make_pair(system.getAccountLoans(patronId), system.getAccountHolds(patronId));
+    });
+
+    setAccountBusy(true);
+    hinlibs::whenReady(this, future, [this](const auto& account) {
+        setAccountBusy(false);
+        showAccountTables(account.first, account.second);
+    });
+}
+
+void PatronWindow::showAccountTables(const std::vector<hinlibs::LibrarySystem::AccountLoan>& loans,
+                                     const std::vector<hinlibs::LibrarySystem::AccountHold>& holds) {
     // Loans
-    auto loans = system_->getAccountLoans(patron_->id());
     auto* loansModel = new QStandardItemModel(this);
     loansModel->setHorizontalHeaderLabels({"Item ID", "Title", "Due Date", "Days Remaining"});
     for (const auto& l : loans) {
@@ -147,7 +205,6 @@ void PatronWindow::populateAccountTables() {
     ui->loansTable->horizontalHeader()->setStretchLastSection(true);
 
     // Holds
-    auto holds = system_->getAccountHolds(patron_->id());
     auto* holdsModel = new QStandardItemModel(this);
     holdsModel->setHorizontalHeaderLabels({"Item ID", "Title", "Queue Position"});
     for (const auto& h : holds) {
@@ -179,6 +236,19 @@ void PatronWindow::populateAccountTables() {
 //    ui->logsTable->horizontalHeader()->setStretchLastSection(true);
 }
 
+void PatronWindow::setBrowseBusy(bool busy) {
+    ui->btnBorrow->setEnabled(!busy);
+    ui->btnPlaceHold->setEnabled(!busy);
+}
+
+void PatronWindow::setAccountBusy(bool busy) {
+    accountRequests_ = std::max(0, accountRequests_ + (busy ? 1 : -1));
+    const bool idle = accountRequests_ == 0;
+    ui->btnReturn->setEnabled(idle);
+    ui->btnCancelHold->setEnabled(idle);
+    ui->btnRefreshAccount->setEnabled(idle);
+}
+
 void PatronWindow::onRefreshAccount() {
     populateAccountTables();
 }
@@ -186,7 +256,7 @@ void PatronWindow::onRefreshAccount() {
 void PatronWindow::onLogOut() {
     close();
 
-    auto* newLogin = new LoginWindow(system_, nullptr);
+    auto* newLogin = new LoginWindow(library_, nullptr);
     newLogin->setAttribute(Qt::WA_DeleteOnClose);
     newLogin->show();
 }
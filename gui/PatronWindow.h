@@ -1,7 +1,7 @@
 #pragma once
 #include <QMainWindow>
 #include <memory>
-#include "models/LibrarySystem.h"
+#include "models/AsyncLibrarySystem.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class PatronWindow; }
@@ -12,7 +12,7 @@ class CatalogueModel;
 class PatronWindow : public QMainWindow {
     Q_OBJECT
 public:
-    PatronWindow(std::shared_ptr<hinlibs::LibrarySystem> system,
+    PatronWindow(std::shared_ptr<hinlibs::AsyncLibrarySystem> library,
                  std::shared_ptr<hinlibs::Patron> patron,
                  QWidget* parent = nullptr);
     ~PatronWindow();
@@ -22,6 +22,9 @@ private slots:
     void onBorrow();
     void onPlaceHold();
     void onRefreshBrowse();
+    void onSearchBrowse();
+    void onBrowseTextChanged(const QString& text);
+    void onBrowseFilterChanged();
 
     // Account tab
     void onReturn();
@@ -31,10 +34,18 @@ private slots:
 
 private:
     void populateAccountTables();
+    void showAccountTables(const std::vector<hinlibs::LibrarySystem::AccountLoan>& loans,
+                           const std::vector<hinlibs::LibrarySystem::AccountHold>& holds);
+    // Disable the buttons of a tab while its database request is in flight. Account
+    // requests can overlap (a return, then the refresh it triggers, or the timer), so
+    // each true is matched by one false and the buttons come back after the last one.
+    void setBrowseBusy(bool busy);
+    void setAccountBusy(bool busy);
 
     std::unique_ptr<Ui::PatronWindow> ui;
-    std::shared_ptr<hinlibs::LibrarySystem> system_;
+    std::shared_ptr<hinlibs::AsyncLibrarySystem> library_;
     std::shared_ptr<hinlibs::Patron> patron_;
     CatalogueModel* catalogueModel_{nullptr};
+    int accountRequests_{0};    // account requests in flight
 };
 
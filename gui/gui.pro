@@ -0,0 +1,34 @@
+QT += core gui widgets
+
+CONFIG += c++17
+TARGET = HinLIBS
+
+include(../models/models.pri)
+include(../db/db.pri)
+
+SOURCES += \
+    main.cpp \
+    LoginWindow.cpp \
+    PatronWindow.cpp \
+    CatalogueModel.cpp \
+    LibrarianWindow.cpp \
+    AddItemDialog.cpp
+
+HEADERS += \
+    LoginWindow.h \
+    PatronWindow.h \
+    CatalogueModel.h \
+    LibrarianWindow.h \
+    AddItemDialog.h
+
+FORMS += \
+    LoginWindow.ui \
+    PatronWindow.ui \
+    LibrarianWindow.ui \
+    AddItemDialog.ui
+
+INCLUDEPATH += $$PWD
+
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,26 @@
+#include <QApplication>
+#include <QTimer>
+#include <memory>
+
+#include "AsyncLibrarySystem.h"
+#include "LoginWindow.h"
+
+namespace {
+constexpr int DUE_DATE_CHECK_INTERVAL_MS = 60 * 1000;
+}
+
+int main(int argc, char* argv[]) {
+    QApplication app(argc, argv);
+
+    auto library = std::make_shared<hinlibs::AsyncLibrarySystem>();
+
+    // Loans change standing when the date does; checks within the same day cost nothing.
+    QTimer dueDateTimer;
+    QObject::connect(&dueDateTimer, &QTimer::timeout, [library]() { library->runDueDateCheck(); });
+    dueDateTimer.start(DUE_DATE_CHECK_INTERVAL_MS);
+
+    LoginWindow login(library);
+    login.show();
+
+    return app.exec();
+}
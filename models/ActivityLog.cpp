@@ -0,0 +1,274 @@
+#include "ActivityLog.h"
+#include "ConnectionPool.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QFileInfo>
+#include <QSettings>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QtGlobal>
+#include <algorithm>
+#include <optional>
+
+namespace hinlibs {
+
+namespace {
+
+std::size_t roundUpToPowerOfTwo(std::size_t value) {
+    std::size_t power = 2;
+    while (power < value) power <<= 1;
+    return power;
+}
+
+qint64 settingNumber(const QSettings& settings, const char* key, qint64 fallback) {
+    const QVariant value = settings.value(key);
+    if (!value.isValid()) return fallback;
+    bool ok = false;
+    const qint64 parsed = value.toString().trimmed().toLongLong(&ok);
+    if (!ok || parsed <= 0) {
+        qDebug() << "WARNING: ignoring activity log setting" << key << "=" << value.toString();
+        return fallback;
+    }
+    return parsed;
+}
+
+} // namespace
+
+// --- ActivityRing ---
+
+ActivityRing::ActivityRing(std::size_t capacity)
+    : cells_(new Cell[roundUpToPowerOfTwo(capacity)]),
+      mask_(roundUpToPowerOfTwo(capacity) - 1) {
+    for (std::size_t i = 0; i <= mask_; ++i) cells_[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+// A cell is free for position p when its sequence is p, and holds an event for
+// position p when its sequence is p + 1. Popping hands it to position p + capacity.
+bool ActivityRing::tryPush(const ActivityEvent& event) {
+    std::size_t position = pushPosition_.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+        cell = &cells_[position & mask_];
+        const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const auto lag = static_cast<std::ptrdiff_t>(sequence - position);
+        if (lag == 0) {
+            if (pushPosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+        } else if (lag < 0) {
+            return false;       // full
+        } else {
+            position = pushPosition_.load(std::memory_order_relaxed);
+        }
+    }
+    cell->event = event;
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool ActivityRing::tryPop(ActivityEvent& event) {
+    std::size_t position = popPosition_.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+        cell = &cells_[position & mask_];
+        const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const auto lag = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+        if (lag == 0) {
+            if (popPosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+        } else if (lag < 0) {
+            return false;       // empty
+        } else {
+            position = popPosition_.load(std::memory_order_relaxed);
+        }
+    }
+    event = cell->event;
+    cell->sequence.store(position + mask_ + 1, std::memory_order_release);
+    return true;
+}
+
+std::size_t ActivityRing::size() const noexcept {
+    const std::size_t pushed = pushPosition_.load(std::memory_order_relaxed);
+    const std::size_t popped = popPosition_.load(std::memory_order_relaxed);
+    return pushed > popped ? pushed - popped : 0;
+}
+
+// --- ActivityLogOptions ---
+
+ActivityLogOptions ActivityLogOptions::fromEnvironment() {
+    ActivityLogOptions options;
+    const QString configPath = qEnvironmentVariable("HINLIBS_DB_CONFIG", "db/hinlibs.ini");
+    if (!QFileInfo::exists(configPath)) return options;
+
+    QSettings settings(configPath, QSettings::IniFormat);
+    settings.beginGroup("activity_log");
+    options.capacity = static_cast<std::size_t>(
+        settingNumber(settings, "capacity", static_cast<qint64>(options.capacity)));
+    options.flushInterval = std::chrono::milliseconds(
+        settingNumber(settings, "flush_interval_ms", options.flushInterval.count()));
+    options.blockTimeout = std::chrono::milliseconds(
+        settingNumber(settings, "block_timeout_ms", options.blockTimeout.count()));
+
+    const QString overflow = settings.value("overflow").toString().trimmed().toLower();
+    if (overflow == "drop_newest") {
+        options.overflow = ActivityOverflow::DropNewest;
+    } else if (overflow == "drop_oldest") {
+        options.overflow = ActivityOverflow::DropOldest;
+    } else if (overflow == "block") {
+        options.overflow = ActivityOverflow::Block;
+    } else if (!overflow.isEmpty()) {
+        qDebug() << "WARNING: ignoring activity log setting overflow =" << overflow;
+    }
+    settings.endGroup();
+    return options;
+}
+
+// --- ActivityLogger ---
+
+ActivityLogger::ActivityLogger(ConnectionPool& pool, const ActivityLogOptions& options)
+    : pool_(pool),
+      options_(options),
+      ring_(options.capacity),
+      wakeThreshold_(ring_.capacity() / 2),
+      writer_([this]() { run(); }) {}
+
+ActivityLogger::~ActivityLogger() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        stopping_ = true;
+    }
+    wakeUp_.notify_one();
+    writer_.join();
+}
+
+bool ActivityLogger::log(int userId, Activity activity, int itemId) {
+    const qint64 now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::system_clock::now().time_since_epoch()).count();
+    const ActivityEvent event{ userId, itemId, now, activity };
+    logged_.fetch_add(1, std::memory_order_relaxed);
+
+    std::optional<std::chrono::steady_clock::time_point> deadline;   // set on the first full ring under Block
+    for (;;) {
+        if (ring_.tryPush(event)) {
+            if (ring_.size() >= wakeThreshold_) wake();
+            return true;
+        }
+        switch (options_.overflow) {
+        case ActivityOverflow::DropNewest:
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        case ActivityOverflow::DropOldest: {
+            ActivityEvent oldest;
+            if (ring_.tryPop(oldest)) dropped_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+        case ActivityOverflow::Block: {
+            const auto now = std::chrono::steady_clock::now();
+            if (!deadline) deadline = now + options_.blockTimeout;
+            if (now >= *deadline) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            wake();
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            spaceFreed_.wait_until(lock, *deadline, [this]() { return ring_.size() < ring_.capacity(); });
+            break;
+        }
+        }
+    }
+}
+
+// Only the first producer past the threshold takes the mutex; the rest see the flag set.
+void ActivityLogger::wake() {
+    if (wakeRequested_.exchange(true, std::memory_order_acq_rel)) return;
+    std::lock_guard<std::mutex> lock(wakeMutex_);
+    wakeUp_.notify_one();
+}
+
+bool ActivityLogger::flush() {
+    const std::uint64_t target = logged_.load(std::memory_order_acquire);
+    wake();
+    const auto patience = std::max<std::chrono::milliseconds>(options_.flushInterval * 10, std::chrono::seconds(10));
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    return flushed_.wait_for(lock, patience, [&]() { return written_.load() + dropped_.load() >= target; });
+}
+
+ActivityLogStats ActivityLogger::stats() const noexcept {
+    return { logged_.load(std::memory_order_relaxed), written_.load(std::memory_order_relaxed),
+             dropped_.load(std::memory_order_relaxed) };
+}
+
+QString ActivityLogger::describe(Activity activity, int itemId) {
+    switch (activity) {
+    case Activity::Borrowed: return QString("Borrowed Item with Id %1").arg(itemId);
+    case Activity::Returned: return QString("Returned Item with Id %1").arg(itemId);
+    case Activity::PlacedHold: return QString("Placed hold on Item with Id %1").arg(itemId);
+    case Activity::CancelledHold: return QString("Cancelled hold on Item with Id %1").arg(itemId);
+    }
+    return QString();
+}
+
+void ActivityLogger::run() {
+    std::vector<ActivityEvent> batch;
+    batch.reserve(ring_.capacity());
+    for (;;) {
+        bool stopping = false;
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            wakeUp_.wait_for(lock, options_.flushInterval, [this]() {
+                return stopping_ || wakeRequested_.load(std::memory_order_acquire);
+            });
+            wakeRequested_.store(false, std::memory_order_release);
+            stopping = stopping_;
+        }
+
+        // A batch that failed last time goes first, so rows stay in logging order.
+        ActivityEvent event;
+        const std::size_t carried = batch.size();
+        while (batch.size() < ring_.capacity() && ring_.tryPop(event)) batch.push_back(event);
+        if (batch.size() > carried) {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            spaceFreed_.notify_all();
+        }
+        const bool written = batch.empty() || writeBatch(batch);
+
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            flushed_.notify_all();
+        }
+        if (stopping && (ring_.size() == 0 || !written)) break;
+    }
+    if (!batch.empty()) {
+        qDebug() << "ERROR: activity log lost" << batch.size() + ring_.size() << "events at shutdown";
+    }
+}
+
+bool ActivityLogger::writeBatch(std::vector<ActivityEvent>& batch) {
+    QSqlDatabase db = pool_.connection();
+    if (!db.isOpen() || !db.transaction()) {
+        qDebug() << "ERROR:" << db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery insert(db);
+    insert.prepare("INSERT INTO useractivity (userid_, activity_, timestamp_) VALUES (:userid_, :activity_, :timestamp_)");
+    for (const ActivityEvent& event : batch) {
+        insert.bindValue(":userid_", event.userId);
+        insert.bindValue(":activity_", describe(event.activity, event.itemId));
+        insert.bindValue(":timestamp_",
+                         QDateTime::fromMSecsSinceEpoch(event.msecsSinceEpoch).toString("yyyy-MM-dd HH:mm:ss"));
+        if (!insert.exec()) {
+            qDebug() << "ERROR:" << insert.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+    if (!db.commit()) {
+        qDebug() << "ERROR:" << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    written_.fetch_add(batch.size(), std::memory_order_relaxed);
+    batch.clear();
+    return true;
+}
+
+} // namespace hinlibs
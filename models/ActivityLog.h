@@ -0,0 +1,123 @@
+#pragma once
+#include <QString>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hinlibs {
+
+class ConnectionPool;
+
+enum class Activity : std::uint8_t { Borrowed, Returned, PlacedHold, CancelledHold };
+
+// One useractivity row before it is formatted; fixed size, so logging never allocates.
+struct ActivityEvent {
+    int userId;
+    int itemId;
+    qint64 msecsSinceEpoch;
+    Activity activity;
+};
+
+// Bounded multi-producer, multi-consumer queue without locks (D. Vyukov's design): each
+// cell carries a sequence number that tells producers and consumers whose turn it is,
+// so a push or pop is one compare-and-swap on its position counter in the common case.
+class ActivityRing {
+public:
+    // capacity is rounded up to a power of two.
+    explicit ActivityRing(std::size_t capacity);
+
+    bool tryPush(const ActivityEvent& event);
+    bool tryPop(ActivityEvent& event);
+
+    std::size_t capacity() const noexcept { return mask_ + 1; }
+    // Exact only when no push or pop is in progress.
+    std::size_t size() const noexcept;
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        ActivityEvent event;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    std::size_t mask_;
+    alignas(64) std::atomic<std::size_t> pushPosition_{0};
+    alignas(64) std::atomic<std::size_t> popPosition_{0};
+};
+
+// What log() does when the ring is full.
+enum class ActivityOverflow { DropNewest, DropOldest, Block };
+
+// Read from the [activity_log] group of the INI file named by HINLIBS_DB_CONFIG (default
+// db/hinlibs.ini, if present): capacity, flush_interval_ms, overflow (drop_newest,
+// drop_oldest or block), block_timeout_ms.
+struct ActivityLogOptions {
+    std::size_t capacity = 8192;
+    std::chrono::milliseconds flushInterval{200};
+    ActivityOverflow overflow = ActivityOverflow::DropNewest;
+    // With Block, how long log() waits for the writer to free a slot before it drops the event.
+    std::chrono::milliseconds blockTimeout{1000};
+
+    static ActivityLogOptions fromEnvironment();
+};
+
+struct ActivityLogStats {
+    std::uint64_t logged;
+    std::uint64_t written;
+    std::uint64_t dropped;      // lost to overflow
+};
+
+// Group-commit writer for the useractivity table. log() only pushes onto the ring; a
+// background thread drains it every flushInterval, or sooner once it is half full, and
+// inserts each batch in one transaction on its own connection from pool. A batch that
+// fails to commit is kept and retried on the next flush. The destructor writes out
+// whatever is still queued.
+class ActivityLogger {
+public:
+    ActivityLogger(ConnectionPool& pool, const ActivityLogOptions& options);
+    ~ActivityLogger();
+
+    ActivityLogger(const ActivityLogger&) = delete;
+    ActivityLogger& operator=(const ActivityLogger&) = delete;
+
+    // Returns false if the event was dropped. Safe to call from any thread. With Block, waits
+    // at most blockTimeout for room, so a writer that keeps failing cannot hang the caller.
+    bool log(int userId, Activity activity, int itemId);
+    // Wakes the writer and waits until everything logged so far has been written or dropped.
+    // Returns false if that takes longer than ten flush intervals (at least ten seconds).
+    bool flush();
+
+    ActivityLogStats stats() const noexcept;
+
+    // The activity_ text, e.g. "Borrowed Item with Id 14".
+    static QString describe(Activity activity, int itemId);
+
+private:
+    void run();
+    bool writeBatch(std::vector<ActivityEvent>& batch);
+    void wake();
+
+    ConnectionPool& pool_;
+    const ActivityLogOptions options_;
+    ActivityRing ring_;
+    const std::size_t wakeThreshold_;
+
+    std::atomic<std::uint64_t> logged_{0};
+    std::atomic<std::uint64_t> written_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+
+    std::mutex wakeMutex_;
+    std::condition_variable wakeUp_;
+    std::condition_variable flushed_;
+    std::condition_variable spaceFreed_;            // the writer took events off the ring
+    std::atomic<bool> wakeRequested_{false};
+    bool stopping_ = false;                         // guarded by wakeMutex_
+    std::thread writer_;
+};
+
+} // namespace hinlibs
@@ -0,0 +1,79 @@
+#include "AsyncLibrarySystem.h"
+
+namespace hinlibs {
+
+AsyncLibrarySystem::AsyncLibrarySystem(const QString& databasePath, const DatabaseProfile& profile) {
+    worker_.setMaxThreadCount(1);
+    worker_.setExpiryTimeout(-1);
+    readers_.setMaxThreadCount(LibrarySystem::MAX_READ_CONNECTIONS);
+    readers_.setExpiryTimeout(-1);
+
+    // Run migrations and load the caches on the worker; this is the only blocking wait.
+    system_ = QtConcurrent::run(&worker_, [databasePath, profile]() {
+        return std::make_shared<LibrarySystem>(databasePath, profile);
+    }).result();
+}
+
+AsyncLibrarySystem::~AsyncLibrarySystem() {
+    readers_.waitForDone();
+    // Let the worker drop its reference so the pool is torn down on the thread that created it.
+    QtConcurrent::run(&worker_, [system = std::move(system_)]() mutable { system.reset(); });
+    worker_.waitForDone();
+}
+
+QFuture<bool> AsyncLibrarySystem::borrowItem(int patronId, int itemId) {
+    return run([=](LibrarySystem& s) { return s.borrowItem(patronId, itemId); });
+}
+
+QFuture<bool> AsyncLibrarySystem::returnItem(int patronId, int itemId) {
+    return run([=](LibrarySystem& s) { return s.returnItem(patronId, itemId); });
+}
+
+QFuture<bool> AsyncLibrarySystem::placeHold(int patronId, int itemId) {
+    return run([=](LibrarySystem& s) { return s.placeHold(patronId, itemId); });
+}
+
+QFuture<bool> AsyncLibrarySystem::cancelHold(int patronId, int itemId) {
+    return run([=](LibrarySystem& s) { return s.cancelHold(patronId, itemId); });
+}
+
+QFuture<bool> AsyncLibrarySystem::isLoanedBy(int itemId, int patronId) {
+    return runRead([=](LibrarySystem& s) { return s.isLoanedBy(itemId, patronId); });
+}
+
+QFuture<std::vector<LibrarySystem::AccountLoan>> AsyncLibrarySystem::getAccountLoans(int patronId) {
+    return runRead([=](LibrarySystem& s) { return s.getAccountLoans(patronId); });
+}
+
+QFuture<std::vector<LibrarySystem::AccountHold>> AsyncLibrarySystem::getAccountHolds(int patronId) {
+    return runRead([=](LibrarySystem& s) { return s.getAccountHolds(patronId); });
+}
+
+QFuture<bool> AsyncLibrarySystem::addItemToCatalogue(int librarianId, const ItemInDB& data) {
+    return run([=](LibrarySystem& s) { return s.addItemToCatalogue(librarianId, data); });
+}
+
+QFuture<bool> AsyncLibrarySystem::removeItemFromCatalogue(int librarianId, int itemId) {
+    return run([=](LibrarySystem& s) { return s.removeItemFromCatalogue(librarianId, itemId); });
+}
+
+QFuture<std::shared_ptr<User>> AsyncLibrarySystem::librarianFindPatronByName(const std::string& name) {
+    return runRead([=](LibrarySystem& s) { return s.LibrarianFindPatronByName(name); });
+}
+
+QFuture<std::vector<LibrarySystem::LoanEvent>> AsyncLibrarySystem::runDueDateCheck() {
+    return run([](LibrarySystem& s) { return s.runDueDateCheck(); });
+}
+
+QFuture<std::vector<ItemView>>
+AsyncLibrarySystem::searchCatalogue(const LibrarySystem::CatalogueSearch& search) {
+    return runRead([=](LibrarySystem& s) { return s.searchCatalogue(search); });
+}
+
+QFuture<std::vector<ItemView>> AsyncLibrarySystem::itemsAfter(int afterItemId, std::size_t limit,
+                                                             std::optional<CatalogueKind> kind,
+                                                             std::optional<ItemStatus> status) {
+    return runRead([=](LibrarySystem& s) { return s.itemsAfter(afterItemId, limit, kind, status); });
+}
+
+} // namespace hinlibs
@@ -0,0 +1,86 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include "LibrarySystem.h"
+
+namespace hinlibs {
+
+// Runs LibrarySystem database work off the GUI thread so it never blocks on SQLite.
+// Writes are serialised on one dedicated worker; read-only queries fan out over a
+// small reader pool whose threads each hold one of LibrarySystem's read connections.
+class AsyncLibrarySystem {
+public:
+    explicit AsyncLibrarySystem(const QString& databasePath = LibrarySystem::DEFAULT_DATABASE_PATH,
+                                const DatabaseProfile& profile = DatabaseProfile::fromEnvironment());
+    ~AsyncLibrarySystem();
+
+    AsyncLibrarySystem(const AsyncLibrarySystem&) = delete;
+    AsyncLibrarySystem& operator=(const AsyncLibrarySystem&) = delete;
+
+    // Direct access for the in-memory lookups; SQL-backed calls on it block the caller.
+    std::shared_ptr<LibrarySystem> system() const { return system_; }
+
+    // Runs work(LibrarySystem&) on the write worker.
+    template <typename Work>
+    auto run(Work work) -> QFuture<decltype(work(std::declval<LibrarySystem&>()))> {
+        auto system = system_;
+        return QtConcurrent::run(&worker_, [system, work]() { return work(*system); });
+    }
+
+    // Runs read-only work(LibrarySystem&) on the reader pool.
+    template <typename Work>
+    auto runRead(Work work) -> QFuture<decltype(work(std::declval<LibrarySystem&>()))> {
+        auto system = system_;
+        return QtConcurrent::run(&readers_, [system, work]() { return work(*system); });
+    }
+
+    // --- Patron operations ---
+    QFuture<bool> borrowItem(int patronId, int itemId);
+    QFuture<bool> returnItem(int patronId, int itemId);
+    QFuture<bool> placeHold(int patronId, int itemId);
+    QFuture<bool> cancelHold(int patronId, int itemId);
+    QFuture<bool> isLoanedBy(int itemId, int patronId);
+    QFuture<std::vector<LibrarySystem::AccountLoan>> getAccountLoans(int patronId);
+    QFuture<std::vector<LibrarySystem::AccountHold>> getAccountHolds(int patronId);
+
+    // --- Librarian operations ---
+    QFuture<bool> addItemToCatalogue(int librarianId, const ItemInDB& data);
+    QFuture<bool> removeItemFromCatalogue(int librarianId, int itemId);
+    QFuture<std::shared_ptr<User>> librarianFindPatronByName(const std::string& name);
+
+    // --- Due dates ---
+    QFuture<std::vector<LibrarySystem::LoanEvent>> runDueDateCheck();
+
+    // --- Catalogue ---
+    QFuture<std::vector<ItemView>> searchCatalogue(const LibrarySystem::CatalogueSearch& search);
+    QFuture<std::vector<ItemView>> itemsAfter(int afterItemId, std::size_t limit,
+                                              std::optional<CatalogueKind> kind,
+                                              std::optional<ItemStatus> status);
+
+private:
+    QThreadPool worker_;    // exactly one thread that never expires, so its connection stays open
+    QThreadPool readers_;   // up to LibrarySystem::MAX_READ_CONNECTIONS long-lived threads
+    std::shared_ptr<LibrarySystem> system_;
+};
+
+// Calls onReady(result) on context's thread once future finishes; dropped if context is destroyed first.
+template <typename T, typename OnReady>
+void whenReady(QObject* context, const QFuture<T>& future, OnReady onReady) {
+    auto* watcher = new QFutureWatcher<T>(context);
+    QObject::connect(watcher, &QFutureWatcherBase::finished, context, [watcher, onReady]() {
+        watcher->deleteLater();
+        onReady(watcher->result());
+    });
+    watcher->setFuture(future);
+}
+
+} // namespace hinlibs
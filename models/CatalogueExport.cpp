@@ -0,0 +1,147 @@
+#include "CatalogueExport.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <algorithm>
+
+namespace hinlibs {
+
+namespace {
+
+struct Column {
+    const char* name;
+    const char* expression;
+};
+
+const std::vector<Column> ITEM_COLUMNS = {
+    { "itemid", "i.itemid_" },
+    { "kind", "i.kind_" },
+    { "title", "i.title_" },
+    { "creator", "i.creator_" },
+    { "publicationYear", "i.publicationYear_" },
+    { "dewey", "i.dewey_" },
+    { "isbn", "i.isbn_" },
+    { "issueNumber", "i.issueNumber_" },
+    { "publicationDate", "i.publicationDate_" },
+    { "genre", "i.genre_" },
+    { "rating", "i.rating_" },
+    { "status", "i.status_" },
+};
+
+const std::vector<Column> LOAN_COLUMNS = {
+    { "loanid", "l.loanid_" },
+    { "itemid", "l.itemid_" },
+    { "userid", "l.userid_" },
+    { "patron", "u.name_" },
+    { "title", "i.title_" },
+    { "kind", "i.kind_" },
+    { "status", "i.status_" },
+    { "checkoutDate", "l.checkoutDate_" },
+    { "dueDate", "l.dueDate_" },
+};
+
+void appendCsvField(QByteArray& line, const QVariant& value) {
+    if (value.isNull()) return;
+    const QByteArray text = value.toString().toUtf8();
+    if (!text.contains(',') && !text.contains('"') && !text.contains('\n') && !text.contains('\r')) {
+        line += text;
+        return;
+    }
+    line += '"';
+    for (char c : text) {
+        if (c == '"') line += '"';
+        line += c;
+    }
+    line += '"';
+}
+
+} // namespace
+
+ExportQuery buildExportQuery(const ExportOptions& options) {
+    ExportQuery query;
+    const bool loans = options.table == ExportTable::Loans;
+    const std::vector<Column>& available = loans ? LOAN_COLUMNS : ITEM_COLUMNS;
+
+    std::vector<const Column*> selected;
+    if (options.columns.isEmpty()) {
+        for (const Column& column : available) selected.push_back(&column);
+    } else {
+        for (const QString& name : options.columns) {
+            auto it = std::find_if(available.begin(), available.end(),
+                                   [&name](const Column& c) { return name.trimmed() == c.name; });
+            if (it == available.end()) {
+                query.error = "unknown column '" + name.toStdString() + "'";
+                return query;
+            }
+            selected.push_back(&*it);
+        }
+    }
+
+    QStringList expressions;
+    for (const Column* column : selected) {
+        expressions << column->expression;
+        query.columns << column->name;
+    }
+
+    QString sql = "SELECT " + expressions.join(", ");
+    sql += loans ? " FROM loans l JOIN items i ON i.itemid_ = l.itemid_ JOIN users u ON u.userid_ = l.userid_"
+                 : " FROM items i";
+    sql += " WHERE 1 = 1";
+
+    if (options.kind) {
+        sql += " AND i.kind_ = :kind";
+        query.bindings.emplace_back(":kind", QString::fromStdString(*options.kind));
+    }
+    if (options.status) {
+        sql += " AND i.status_ = :status";
+        query.bindings.emplace_back(":status", *options.status == ItemStatus::Available ? "Available" : "CheckedOut");
+    }
+    if (options.from.isValid()) {
+        sql += loans ? " AND l.dueDate_ >= :from" : " AND i.publicationYear_ >= :from";
+        query.bindings.emplace_back(":from", loans ? QVariant(options.from.toString("yyyy-MM-dd")) : QVariant(options.from.year()));
+    }
+    if (options.to.isValid()) {
+        sql += loans ? " AND l.dueDate_ <= :to" : " AND i.publicationYear_ <= :to";
+        query.bindings.emplace_back(":to", loans ? QVariant(options.to.toString("yyyy-MM-dd")) : QVariant(options.to.year()));
+    }
+
+    // Primary-key order, so the export walks the table instead of sorting it.
+    sql += loans ? " ORDER BY l.loanid_" : " ORDER BY i.itemid_";
+    query.sql = sql;
+    return query;
+}
+
+RecordWriter::RecordWriter(QIODevice& sink, ExportFormat format, QStringList columns)
+    : sink_(sink), format_(format), columns_(std::move(columns)) {}
+
+bool RecordWriter::writeHeader() {
+    if (format_ != ExportFormat::Csv) return true;
+    line_.clear();
+    for (int c = 0; c < columns_.size(); ++c) {
+        if (c > 0) line_ += ',';
+        line_ += columns_[c].toUtf8();
+    }
+    line_ += '\n';
+    return sink_.write(line_) == line_.size();
+}
+
+bool RecordWriter::writeRow(const std::vector<QVariant>& values) {
+    line_.clear();
+    if (format_ == ExportFormat::Csv) {
+        for (std::size_t c = 0; c < values.size(); ++c) {
+            if (c > 0) line_ += ',';
+            appendCsvField(line_, values[c]);
+        }
+    } else {
+        QJsonObject object;
+        for (std::size_t c = 0; c < values.size(); ++c) {
+            object.insert(columns_[static_cast<int>(c)], QJsonValue::fromVariant(values[c]));
+        }
+        line_ += QJsonDocument(object).toJson(QJsonDocument::Compact);
+    }
+    line_ += '\n';
+    return sink_.write(line_) == line_.size();
+}
+
+} // namespace hinlibs
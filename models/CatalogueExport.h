@@ -0,0 +1,63 @@
+#pragma once
+#include <QDate>
+#include <QIODevice>
+#include <QStringList>
+#include <QVariant>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Item.h"
+
+namespace hinlibs {
+
+enum class ExportFormat { Csv, JsonLines };
+enum class ExportTable { Items, Loans };
+
+// What LibrarySystem::exportRecords writes. Columns and filters are optional.
+//
+// Items columns:  itemid, kind, title, creator, publicationYear, dewey, isbn,
+//                 issueNumber, publicationDate, genre, rating, status
+// Loans columns:  loanid, itemid, userid, patron, title, kind, status,
+//                 checkoutDate, dueDate
+//
+// kind and status filter on the item (for loans, the loaned item). The date range is
+// inclusive and applies to dueDate for loans and to publicationYear (the years of
+// the bounds) for items.
+struct ExportOptions {
+    ExportTable table = ExportTable::Items;
+    ExportFormat format = ExportFormat::Csv;
+    QStringList columns;                    // empty means every column, in the order above
+    std::optional<std::string> kind;        // items.kind_ value, e.g. "Movie"
+    std::optional<ItemStatus> status;
+    QDate from;                             // invalid means unbounded
+    QDate to;
+};
+
+// SELECT statement and bound values for an export, built only from known column names.
+struct ExportQuery {
+    QString sql;
+    std::vector<std::pair<QString, QVariant>> bindings;
+    QStringList columns;
+    std::string error;                      // set if an option is invalid; sql is then empty
+};
+
+ExportQuery buildExportQuery(const ExportOptions& options);
+
+// Writes rows one at a time, so memory use does not grow with the export.
+class RecordWriter {
+public:
+    RecordWriter(QIODevice& sink, ExportFormat format, QStringList columns);
+
+    // CSV only; JSON Lines rows name their own fields.
+    bool writeHeader();
+    bool writeRow(const std::vector<QVariant>& values);
+
+private:
+    QIODevice& sink_;
+    ExportFormat format_;
+    QStringList columns_;
+    QByteArray line_;                       // reused for every row
+};
+
+} // namespace hinlibs
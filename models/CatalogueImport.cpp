@@ -0,0 +1,199 @@
+#include "CatalogueImport.h"
+
+#include <QDate>
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <QJsonValue>
+#include <QVariant>
+#include <functional>
+
+namespace hinlibs {
+
+namespace {
+
+const QStringList KINDS = { "FictionBook", "NonFictionBook", "Magazine", "Movie", "VideoGame" };
+const QStringList REQUIRED_FIELDS = { "kind", "title", "creator", "publicationyear" };
+
+// "publicationYear_" and "publicationYear" both name the publicationyear field.
+QString fieldKey(QString name) {
+    name = name.trimmed().toLower();
+    if (name.endsWith('_')) name.chop(1);
+    return name;
+}
+
+// Fills record.item from the named fields, or sets record.error to the first problem found.
+void fillRecord(const std::function<QString(const QString&)>& field, ImportRecord& record) {
+    auto fail = [&record](const std::string& message) { record.error = message; };
+    auto optionalText = [&field](const QString& name) -> std::optional<std::string> {
+        const QString value = field(name).trimmed();
+        if (value.isEmpty()) return std::nullopt;
+        return value.toStdString();
+    };
+
+    ItemInDB& item = record.item;
+    const QString kind = field("kind").trimmed();
+    if (!KINDS.contains(kind)) return fail("kind must be one of " + KINDS.join(", ").toStdString());
+    item.kind_ = kind.toStdString();
+
+    item.title_ = field("title").trimmed().toStdString();
+    item.creator_ = field("creator").trimmed().toStdString();
+    if (item.title_.empty()) return fail("title is empty");
+    if (item.creator_.empty()) return fail("creator is empty");
+
+    bool ok = false;
+    item.publicationYear_ = field("publicationyear").trimmed().toInt(&ok);
+    if (!ok || item.publicationYear_ <= 0) return fail("publicationYear must be a positive integer");
+
+    item.dewey_ = optionalText("dewey");
+    item.isbn_ = optionalText("isbn");
+    item.genre_ = optionalText("genre");
+    item.rating_ = optionalText("rating");
+
+    const QString issue = field("issuenumber").trimmed();
+    if (!issue.isEmpty()) {
+        item.issueNumber_ = issue.toInt(&ok);
+        if (!ok) return fail("issueNumber must be an integer");
+    }
+
+    const QString date = field("publicationdate").trimmed();
+    if (!date.isEmpty()) {
+        const QDate parsed = QDate::fromString(date, "yyyy-MM-dd");
+        if (!parsed.isValid()) return fail("publicationDate must be yyyy-MM-dd");
+        item.publicationDate_ = parsed;
+    }
+
+    // A CheckedOut item needs a loan row, which an import can't supply.
+    const QString status = field("status").trimmed();
+    if (status.isEmpty() || status == "Available") {
+        item.status_ = ItemStatus::Available;
+    } else if (status == "CheckedOut") {
+        return fail("status CheckedOut needs a loan; import the item as Available and check it out");
+    } else {
+        return fail("status must be Available");
+    }
+}
+
+} // namespace
+
+CatalogueRecordReader::CatalogueRecordReader(QIODevice& source, ImportFormat format)
+    : in_(&source), format_(format) {
+    in_.setCodec("UTF-8");
+    if (format_ != ImportFormat::Csv) return;
+
+    qint64 headerLine = 0;
+    if (!readCsvFields(header_, headerLine)) {
+        headerError_ = "input is empty";
+        return;
+    }
+    for (QString& name : header_) name = fieldKey(name);
+    for (const QString& required : REQUIRED_FIELDS) {
+        if (!header_.contains(required)) {
+            headerError_ = "header has no " + required.toStdString() + " column";
+            return;
+        }
+    }
+}
+
+bool CatalogueRecordReader::next(ImportRecord& record) {
+    record = ImportRecord{};
+
+    if (format_ == ImportFormat::Csv) {
+        QStringList fields;
+        if (!readCsvFields(fields, record.line)) return false;
+        if (!headerError_.empty()) {
+            record.error = headerError_;
+        } else if (fields.size() != header_.size()) {
+            record.error = "expected " + std::to_string(header_.size()) + " fields, got " + std::to_string(fields.size());
+        } else {
+            fromCsv(fields, record);
+        }
+        return true;
+    }
+
+    QString text;
+    do {
+        if (in_.atEnd()) return false;
+        text = in_.readLine();
+        ++line_;
+    } while (text.trimmed().isEmpty());
+    record.line = line_;
+
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(text.toUtf8(), &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        record.error = "invalid JSON: " + parseError.errorString().toStdString();
+    } else if (!document.isObject()) {
+        record.error = "expected a JSON object";
+    } else {
+        fromJson(document.object(), record);
+    }
+    return true;
+}
+
+// Reads one CSV record, which may span lines inside a quoted field. Blank lines are skipped.
+bool CatalogueRecordReader::readCsvFields(QStringList& fields, qint64& firstLine) {
+    QString text;
+    do {
+        if (in_.atEnd()) return false;
+        text = in_.readLine();
+        ++line_;
+    } while (text.trimmed().isEmpty());
+    firstLine = line_;
+
+    fields.clear();
+    QString field;
+    bool quoted = false;
+    for (int i = 0;; ++i) {
+        if (i == text.size()) {
+            if (quoted && !in_.atEnd()) {
+                // Line break inside a quoted field: keep it and continue on the next line.
+                field += '\n';
+                text = in_.readLine();
+                ++line_;
+                i = -1;
+                continue;
+            }
+            fields << field;
+            return true;
+        }
+
+        const QChar c = text[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < text.size() && text[i + 1] == '"') {
+                field += '"';
+                ++i;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                field += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields << field;
+            field.clear();
+        } else {
+            field += c;
+        }
+    }
+}
+
+void CatalogueRecordReader::fromCsv(const QStringList& fields, ImportRecord& record) const {
+    fillRecord([&](const QString& name) {
+        const int column = header_.indexOf(name);
+        return column < 0 ? QString() : fields[column];
+    }, record);
+}
+
+void CatalogueRecordReader::fromJson(const QJsonObject& object, ImportRecord& record) const {
+    QJsonObject byKey;
+    for (auto it = object.begin(); it != object.end(); ++it) {
+        byKey.insert(fieldKey(it.key()), it.value());
+    }
+    fillRecord([&](const QString& name) {
+        const QJsonValue value = byKey.value(name);
+        return value.isNull() || value.isUndefined() ? QString() : value.toVariant().toString();
+    }, record);
+}
+
+} // namespace hinlibs
@@ -0,0 +1,64 @@
+#pragma once
+#include <QIODevice>
+#include <QJsonObject>
+#include <QStringList>
+#include <QTextStream>
+#include <string>
+#include <vector>
+
+#include "itemInDB.h"
+
+namespace hinlibs {
+
+enum class ImportFormat { Csv, JsonLines };
+
+// One parsed input record. error is empty if the record is valid and item may be inserted.
+struct ImportRecord {
+    qint64 line = 0;            // first line of the record in the input, 1-based
+    ItemInDB item{};
+    std::string error;
+};
+
+struct ImportRejection {
+    qint64 line;
+    std::string reason;
+};
+
+struct ImportReport {
+    int imported = 0;
+    std::vector<ImportRejection> rejected;
+    bool completed = false;     // false if the import stopped early (unreadable input, database error)
+};
+
+// Streams catalogue records from CSV or JSON Lines and checks each one against the
+// items table constraints: kind_ must be one of the CHECK values, title_ and creator_
+// must be non-empty and publicationYear_ must be a positive integer. status_ may only
+// be Available: a CheckedOut row would have no loan behind it, so it is rejected.
+//
+// Field names are the items column names, with or without the trailing underscore
+// (kind, title, creator, publicationYear, dewey, isbn, issueNumber, publicationDate,
+// genre, rating, status). CSV input needs a header row and may quote fields as in
+// RFC 4180. A missing status means Available.
+class CatalogueRecordReader {
+public:
+    CatalogueRecordReader(QIODevice& source, ImportFormat format);
+
+    // Reads the next record; returns false at end of input.
+    bool next(ImportRecord& record);
+
+    // Set if the CSV header is missing a required column; every record is then rejected.
+    const std::string& headerError() const noexcept { return headerError_; }
+
+private:
+    bool readCsvFields(QStringList& fields, qint64& firstLine);
+    void fromCsv(const QStringList& fields, ImportRecord& record) const;
+    void fromJson(const QJsonObject& object, ImportRecord& record) const;
+
+    QTextStream in_;
+    ImportFormat format_;
+    qint64 line_ = 0;
+    QStringList header_;
+    std::string headerError_;
+};
+
+} // namespace hinlibs
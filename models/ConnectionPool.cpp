@@ -0,0 +1,145 @@
+#include "ConnectionPool.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+#include <algorithm>
+#include <unordered_map>
+
+namespace hinlibs {
+
+namespace {
+
+std::atomic<quint64> nextPoolId{1};
+std::atomic<quint64> nextThreadId{1};
+
+struct OpenConnection {
+    QString name;
+    std::shared_ptr<std::atomic<int>> readOnlySlots;   // read-only connections: the pool counter to give the slot back to
+    std::shared_ptr<void> attachment;                  // read-write connections: see ConnectionPool::attachment
+};
+
+// Closes the connection, after destroying anything that still refers to it.
+void release(OpenConnection& connection) {
+    connection.attachment.reset();
+    if (QSqlDatabase::contains(connection.name)) {
+        QSqlDatabase::database(connection.name, false).close();
+        QSqlDatabase::removeDatabase(connection.name);
+    }
+    if (connection.readOnlySlots) connection.readOnlySlots->fetch_sub(1);
+}
+
+// Per-thread record of the connections opened on this thread; they are closed and
+// unregistered when the thread exits.
+struct ThreadConnections {
+    const quint64 threadId = nextThreadId++;
+    std::unordered_map<quint64, OpenConnection> readWrite;   // poolId -> connection
+    std::unordered_map<quint64, OpenConnection> readOnly;
+
+    ~ThreadConnections() {
+        for (auto* connections : { &readWrite, &readOnly }) {
+            for (auto& entry : *connections) release(entry.second);
+        }
+    }
+};
+
+ThreadConnections& threadConnections() {
+    thread_local ThreadConnections connections;
+    return connections;
+}
+
+} // namespace
+
+ConnectionPool::ConnectionPool(QString databasePath, int maxReadOnly, QStringList pragmas,
+                               QStringList readOnlyPragmas)
+    : poolId_(nextPoolId++),
+      databasePath_(std::move(databasePath)),
+      maxReadOnly_(std::max(0, maxReadOnly)),
+      pragmas_(std::move(pragmas)),
+      readOnlyPragmas_(std::move(readOnlyPragmas)),
+      readOnlyOpen_(std::make_shared<std::atomic<int>>(0)) {}
+
+ConnectionPool::~ConnectionPool() {
+    // Connections on other threads are released when those threads exit; drop ours now.
+    auto& mine = threadConnections();
+    for (auto* connections : { &mine.readWrite, &mine.readOnly }) {
+        auto it = connections->find(poolId_);
+        if (it == connections->end()) continue;
+        release(it->second);
+        connections->erase(it);
+    }
+}
+
+QSqlDatabase ConnectionPool::connection(Access access) {
+    auto& mine = threadConnections();
+
+    if (access == Access::ReadOnly) {
+        auto it = mine.readOnly.find(poolId_);
+        if (it != mine.readOnly.end()) return QSqlDatabase::database(it->second.name, false);
+
+        // Claim one of the bounded read-only slots, or fall back to this thread's writer.
+        int open = readOnlyOpen_->load();
+        while (open < maxReadOnly_ && !readOnlyOpen_->compare_exchange_weak(open, open + 1)) {}
+        if (open < maxReadOnly_) {
+            const QString name = QString("hinlibs-%1-%2-ro").arg(poolId_).arg(mine.threadId);
+            {
+                QSqlDatabase db = this->open(name, Access::ReadOnly);
+                if (db.isOpen()) {
+                    mine.readOnly[poolId_] = { name, readOnlyOpen_, nullptr };
+                    return db;
+                }
+            }
+            // Give the slot back; this thread reads through its writer and may retry next time.
+            QSqlDatabase::removeDatabase(name);
+            readOnlyOpen_->fetch_sub(1);
+        }
+    }
+
+    auto it = mine.readWrite.find(poolId_);
+    if (it != mine.readWrite.end()) return QSqlDatabase::database(it->second.name, false);
+
+    // Only an open connection is kept; after a failed open the next call tries again.
+    const QString name = QString("hinlibs-%1-%2-rw").arg(poolId_).arg(mine.threadId);
+    {
+        QSqlDatabase db = open(name, Access::ReadWrite);
+        if (db.isOpen()) {
+            mine.readWrite[poolId_] = { name, nullptr, nullptr };
+            return db;
+        }
+    }
+    QSqlDatabase::removeDatabase(name);
+    return QSqlDatabase();
+}
+
+std::shared_ptr<void>& ConnectionPool::attachmentSlot() {
+    connection(Access::ReadWrite);
+    auto& readWrite = threadConnections().readWrite;
+    auto it = readWrite.find(poolId_);
+    if (it != readWrite.end()) return it->second.attachment;
+    // No connection to tie it to; keep the object for this call only.
+    thread_local std::shared_ptr<void> unattached;
+    unattached.reset();
+    return unattached;
+}
+
+QSqlDatabase ConnectionPool::open(const QString& name, Access access) {
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", name);
+    db.setDatabaseName(databasePath_);
+    if (access == Access::ReadOnly) {
+        db.setConnectOptions("QSQLITE_OPEN_READONLY");
+    }
+
+    if (!db.open()) {
+        qDebug() << "ERROR: " << db.lastError();
+        return db;
+    }
+
+    QSqlQuery query(db);
+    for (const QString& pragma : access == Access::ReadOnly ? readOnlyPragmas_ : pragmas_) {
+        if (!query.exec(pragma)) {
+            qDebug() << "ERROR:" << pragma << query.lastError().text();
+        }
+    }
+    return db;
+}
+
+} // namespace hinlibs
@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <memory>
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+
+namespace hinlibs {
+
+// Hands every thread its own named QSqlDatabase connection to one SQLite file, since a
+// Qt connection may only be used by the thread that opened it. Read-write connections are
+// opened with pragmas and read-only ones with readOnlyPragmas, since a read-only handle
+// cannot change the journal mode. Read-only connections are capped at maxReadOnly; once
+// the cap is reached, or if a read-only open fails, further threads read through their
+// read-write connection. A thread gives its read-only slot back when it exits.
+class ConnectionPool {
+public:
+    enum class Access { ReadWrite, ReadOnly };
+
+    ConnectionPool(QString databasePath, int maxReadOnly, QStringList pragmas = {},
+                   QStringList readOnlyPragmas = {});
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    // The calling thread's connection, opened on first use. Returns an invalid database
+    // if the file cannot be opened; the next call tries to open it again.
+    QSqlDatabase connection(Access access = Access::ReadWrite);
+
+    const QString& databasePath() const noexcept { return databasePath_; }
+    const QStringList& pragmas() const noexcept { return pragmas_; }
+    const QStringList& readOnlyPragmas() const noexcept { return readOnlyPragmas_; }
+    int maxReadOnly() const noexcept { return maxReadOnly_; }
+    int readOnlyOpen() const noexcept { return readOnlyOpen_->load(); }
+
+    // Per-thread object tied to the calling thread's read-write connection, such as
+    // statements prepared on it. make() creates it on first use; it is destroyed just
+    // before that connection closes, when the thread exits or the pool is destroyed. If the
+    // connection cannot be opened, the object only lives until the next call on this thread.
+    template <typename T, typename Make>
+    T& attachment(Make make) {
+        std::shared_ptr<void>& slot = attachmentSlot();
+        if (!slot) slot = std::shared_ptr<T>(make());
+        return *static_cast<T*>(slot.get());
+    }
+
+private:
+    QSqlDatabase open(const QString& name, Access access);
+    std::shared_ptr<void>& attachmentSlot();
+
+    const quint64 poolId_;
+    const QString databasePath_;
+    const int maxReadOnly_;
+    const QStringList pragmas_;
+    const QStringList readOnlyPragmas_;
+    // Shared with the threads holding a slot, so they can give it back after the pool is gone.
+    const std::shared_ptr<std::atomic<int>> readOnlyOpen_;
+};
+
+} // namespace hinlibs
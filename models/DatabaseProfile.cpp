@@ -0,0 +1,115 @@
+#include "DatabaseProfile.h"
+#include <QDebug>
+#include <QFileInfo>
+#include <QSettings>
+#include <QSqlQuery>
+#include <QtGlobal>
+
+namespace hinlibs {
+
+namespace {
+
+const QStringList JOURNAL_MODES = { "DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL" };
+const QStringList SYNCHRONOUS_MODES = { "OFF", "NORMAL", "FULL", "EXTRA" };
+const QStringList TEMP_STORES = { "DEFAULT", "FILE", "MEMORY" };
+
+// PRAGMA values are spliced into SQL text, so only accept the documented keywords.
+void overrideKeyword(QString& field, const QVariant& value, const QStringList& allowed, const char* key) {
+    if (!value.isValid()) return;
+    const QString upper = value.toString().trimmed().toUpper();
+    if (!allowed.contains(upper)) {
+        qDebug() << "WARNING: ignoring database setting" << key << "=" << value.toString();
+        return;
+    }
+    field = upper;
+}
+
+template <typename T>
+void overrideNumber(T& field, const QVariant& value, const char* key) {
+    if (!value.isValid()) return;
+    bool ok = false;
+    const qint64 parsed = value.toString().trimmed().toLongLong(&ok);
+    if (!ok) {
+        qDebug() << "WARNING: ignoring database setting" << key << "=" << value.toString();
+        return;
+    }
+    field = static_cast<T>(parsed);
+}
+
+} // namespace
+
+QStringList DatabaseProfile::pragmas() const {
+    return {
+        QString("PRAGMA busy_timeout = %1").arg(busyTimeoutMs),
+        QString("PRAGMA journal_mode = %1").arg(journalMode),
+        QString("PRAGMA synchronous = %1").arg(synchronous),
+        QString("PRAGMA mmap_size = %1").arg(mmapSize),
+        QString("PRAGMA cache_size = %1").arg(cacheSize),
+        QString("PRAGMA temp_store = %1").arg(tempStore),
+    };
+}
+
+QStringList DatabaseProfile::readOnlyPragmas() const {
+    return {
+        QString("PRAGMA busy_timeout = %1").arg(busyTimeoutMs),
+        QString("PRAGMA mmap_size = %1").arg(mmapSize),
+        QString("PRAGMA cache_size = %1").arg(cacheSize),
+        QString("PRAGMA temp_store = %1").arg(tempStore),
+    };
+}
+
+DatabaseProfile DatabaseProfile::named(const QString& name) {
+    const QString key = name.trimmed().toLower();
+
+    if (key == "compat") {
+        return { "compat", "DELETE", "FULL", 0, -2000, "DEFAULT", 5000 };
+    }
+    if (key == "durable") {
+        return { "durable", "WAL", "FULL", 0, -16384, "DEFAULT", 5000 };
+    }
+    if (key == "fast") {
+        return { "fast", "WAL", "OFF", 1LL << 30, -262144, "MEMORY", 10000 };
+    }
+    if (!key.isEmpty() && key != "balanced") {
+        qDebug() << "WARNING: unknown database profile" << name << "- using balanced";
+    }
+    return { "balanced", "WAL", "NORMAL", 256LL << 20, -65536, "MEMORY", 5000 };
+}
+
+DatabaseProfile DatabaseProfile::fromEnvironment() {
+    QString configPath = qEnvironmentVariable("HINLIBS_DB_CONFIG", "db/hinlibs.ini");
+    const bool haveConfig = QFileInfo::exists(configPath);
+
+    QString profileName = qEnvironmentVariable("HINLIBS_DB_PROFILE");
+    if (profileName.isEmpty() && haveConfig) {
+        profileName = QSettings(configPath, QSettings::IniFormat).value("database/profile").toString();
+    }
+
+    DatabaseProfile profile = named(profileName);
+    if (!haveConfig) return profile;
+
+    QSettings settings(configPath, QSettings::IniFormat);
+    settings.beginGroup("database");
+    overrideKeyword(profile.journalMode, settings.value("journal_mode"), JOURNAL_MODES, "journal_mode");
+    overrideKeyword(profile.synchronous, settings.value("synchronous"), SYNCHRONOUS_MODES, "synchronous");
+    overrideKeyword(profile.tempStore, settings.value("temp_store"), TEMP_STORES, "temp_store");
+    overrideNumber(profile.mmapSize, settings.value("mmap_size"), "mmap_size");
+    overrideNumber(profile.cacheSize, settings.value("cache_size"), "cache_size");
+    overrideNumber(profile.busyTimeoutMs, settings.value("busy_timeout"), "busy_timeout");
+    settings.endGroup();
+    return profile;
+}
+
+void DatabaseProfile::logEffectiveSettings(QSqlDatabase& db, const QString& profileName) {
+    QStringList effective;
+    QSqlQuery query(db);
+    for (const char* pragma : { "journal_mode", "synchronous", "mmap_size", "cache_size", "temp_store", "busy_timeout" }) {
+        const QString value = query.exec(QString("PRAGMA %1").arg(pragma)) && query.next()
+                                  ? query.value(0).toString()
+                                  : QString("?");
+        effective << QString("%1=%2").arg(pragma, value);
+    }
+    qDebug().noquote() << "Database profile" << profileName << ":" << effective.join(" ");
+}
+
+} // namespace hinlibs
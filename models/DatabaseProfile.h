@@ -0,0 +1,41 @@
+#pragma once
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+
+namespace hinlibs {
+
+// Named set of SQLite tuning PRAGMAs applied to every connection at open time.
+//
+// Built-in profiles: "compat" (SQLite defaults: rollback journal, FULL sync),
+// "balanced" (WAL, NORMAL sync, 256 MiB mmap, 64 MiB cache; the default),
+// "durable" (WAL, FULL sync) and "fast" (WAL, sync OFF, large mmap and cache;
+// bulk loads and benchmarks only).
+//
+// fromEnvironment() picks the profile named by HINLIBS_DB_PROFILE, then applies
+// overrides from the [database] group of the INI file named by HINLIBS_DB_CONFIG
+// (default db/hinlibs.ini, if present): profile, journal_mode, synchronous,
+// mmap_size, cache_size, temp_store, busy_timeout.
+struct DatabaseProfile {
+    QString name;
+    QString journalMode;        // DELETE, TRUNCATE, PERSIST, MEMORY, WAL
+    QString synchronous;        // OFF, NORMAL, FULL, EXTRA
+    qint64 mmapSize = 0;        // bytes
+    int cacheSize = -2000;      // pages if positive, KiB if negative (SQLite convention)
+    QString tempStore;          // DEFAULT, FILE, MEMORY
+    int busyTimeoutMs = 5000;
+
+    QStringList pragmas() const;
+    // The per-connection subset for read-only connections: busy_timeout, mmap_size,
+    // cache_size and temp_store. journal_mode and synchronous only matter to writers.
+    QStringList readOnlyPragmas() const;
+
+    // Returns the built-in profile, or "balanced" with a warning if name is unknown.
+    static DatabaseProfile named(const QString& name);
+    static DatabaseProfile fromEnvironment();
+
+    // Reads the settings back from an open connection and writes them to the log.
+    static void logEffectiveSettings(QSqlDatabase& db, const QString& profileName);
+};
+
+} // namespace hinlibs
@@ -0,0 +1,366 @@
+#include "DatasetGenerator.h"
+#include "LibrarySystem.h"
+
+#include <QDate>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVariant>
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+#include <vector>
+
+namespace hinlibs {
+
+namespace {
+
+const char* const CONNECTION_NAME = "hinlibs-dataset-generator";
+
+// SplitMix64. Unlike the std:: distributions, it gives the same sequence on every platform.
+class Random {
+public:
+    explicit Random(std::uint64_t seed) : state_(seed) {}
+
+    std::uint64_t next() {
+        std::uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, n); n must be positive.
+    int below(int n) { return static_cast<int>(next() % static_cast<std::uint64_t>(n)); }
+
+    // Uniform in [0, 1).
+    double unit() { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); }
+
+private:
+    std::uint64_t state_;
+};
+
+const char* const KINDS[] = { "FictionBook", "NonFictionBook", "Magazine", "Movie", "VideoGame" };
+const char* const TITLE_WORDS[] = {
+    "Silent", "River", "Quantum", "Garden", "Empire", "Shadow", "Northern", "Light",
+    "Hidden", "Atlas", "Winter", "Machine", "Ocean", "Stone", "Golden", "Signal",
+    "Forest", "Harbor", "City", "Glass", "Star", "Trail", "Orbit", "Mist",
+    "Kings", "Aether", "Cipher", "Realms", "History", "Economics", "Cooking", "Astronomy",
+    "Letters", "Memory", "Storm", "Crown", "Meadow", "Voyage", "Origins", "Island",
+    "Fire", "Archive", "Distant", "Summer", "Theory", "Echoes", "Iron", "Lantern",
+};
+const char* const MAGAZINE_SUFFIXES[] = { "Monthly", "Weekly", "Quarterly", "Review", "Digest", "Today" };
+const char* const GIVEN_NAMES[] = {
+    "Alice", "Bob", "Carmen", "Dinesh", "Eve", "Farah", "Gustavo", "Hana",
+    "Ivan", "Jia", "Kofi", "Lena", "Mateo", "Nadia", "Omar", "Priya",
+    "Quinn", "Rosa", "Sami", "Tomas", "Uma", "Victor", "Wen", "Yusuf",
+};
+const char* const SURNAMES[] = {
+    "Chen", "Singh", "Romero", "Ahmed", "Martins", "Rivera", "Daniels", "Patel",
+    "Wong", "Novak", "Adebayo", "Yamamoto", "Okafor", "Kowalski", "Haddad", "Nguyen",
+    "Garcia", "Larsen", "Ivanova", "Mensah", "Dubois", "Costa", "Fischer", "Tanaka",
+};
+const char* const STUDIO_NAMES[] = { "Nebula", "Voxel", "Crown", "Bloom", "Canvas", "Tech", "Wellness", "Pixel" };
+const char* const STUDIO_SUFFIXES[] = { "Works", "Soft", "Labs", "Press", "House", "Media", "Games", "Pub" };
+const char* const GENRES[] = { "Action", "Drama", "Comedy", "Strategy", "Adventure", "Documentary" };
+const char* const RATINGS[] = { "G", "PG", "PG-13", "R", "E", "T", "M" };
+const char* const ACTIVITIES[] = {
+    "Borrowed Item with Id ", "Returned Item with Id ", "Placed hold on Item with Id ", "Cancelled hold on Item with Id ",
+};
+// Words per title, drawn uniformly from this table: mostly two to four, occasionally up to eight.
+const int TITLE_LENGTHS[] = { 1, 1, 1, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 4, 4, 4, 5, 6, 8 };
+
+template <std::size_t N>
+const char* pickFrom(Random& random, const char* const (&words)[N]) {
+    return words[random.below(static_cast<int>(N))];
+}
+
+// Titles and creators follow the shapes of the bundled catalogue: "The Silent Forest"
+// by "J. Rivera", "Tech Monthly" by "TechHouse", "Starfall Odyssey" by "NebulaWorks".
+QString makeTitle(Random& random, int kind) {
+    QStringList words;
+    if (kind == 2) {
+        words << pickFrom(random, TITLE_WORDS);
+        words << pickFrom(random, MAGAZINE_SUFFIXES);
+        return words.join(" ");
+    }
+    if (random.below(10) < 3) words << "The";
+    const int length = TITLE_LENGTHS[random.below(20)];
+    for (int w = 0; w < length; ++w) words << pickFrom(random, TITLE_WORDS);
+    return words.join(" ");
+}
+
+QString makeCreator(Random& random, int kind) {
+    if (kind == 2 || kind == 4) {
+        const QString studio = pickFrom(random, STUDIO_NAMES);
+        return studio + pickFrom(random, STUDIO_SUFFIXES);
+    }
+    const QChar initial('A' + random.below(26));
+    return QString("%1. %2").arg(initial).arg(pickFrom(random, SURNAMES));
+}
+
+int pickKind(Random& random, const std::array<int, 5>& weights) {
+    int total = 0;
+    for (int w : weights) total += std::max(0, w);
+    if (total == 0) return random.below(5);
+
+    int draw = random.below(total);
+    for (int kind = 0; kind < 5; ++kind) {
+        draw -= std::max(0, weights[kind]);
+        if (draw < 0) return kind;
+    }
+    return 4;
+}
+
+// Draws ranks in [0, n) with P(rank k) proportional to 1 / (k + 1)^skew.
+class ZipfSampler {
+public:
+    ZipfSampler(int n, double skew) : cdf_(std::max(0, n)) {
+        double total = 0;
+        for (std::size_t k = 0; k < cdf_.size(); ++k) {
+            total += 1.0 / std::pow(static_cast<double>(k + 1), skew);
+            cdf_[k] = total;
+        }
+        for (double& c : cdf_) c /= total;
+    }
+
+    int draw(Random& random) const {
+        const auto it = std::lower_bound(cdf_.begin(), cdf_.end(), random.unit());
+        return static_cast<int>(std::min<std::ptrdiff_t>(it - cdf_.begin(), cdf_.size() - 1));
+    }
+
+private:
+    std::vector<double> cdf_;
+};
+
+bool copySchema(QSqlDatabase& db, const QString& schemaTemplatePath) {
+    QSqlQuery query(db);
+    query.prepare("ATTACH DATABASE :path AS tpl");
+    query.bindValue(":path", schemaTemplatePath);
+    if (!query.exec()) {
+        qDebug() << "ERROR: cannot attach schema template" << schemaTemplatePath << query.lastError().text();
+        return false;
+    }
+
+    QStringList statements;
+    if (query.exec("SELECT sql FROM tpl.sqlite_master WHERE type = 'table' "
+                   "AND name IN ('users', 'items', 'loans', 'holds', 'useractivity') ORDER BY rowid")) {
+        while (query.next()) statements << query.value(0).toString();
+    }
+    query.exec("DETACH DATABASE tpl");
+
+    if (statements.size() != 5) {
+        qDebug() << "ERROR: schema template" << schemaTemplatePath << "is missing hinlibs tables";
+        return false;
+    }
+    for (const QString& sql : statements) {
+        if (!query.exec(sql)) {
+            qDebug() << "ERROR:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+// Calls bindRow(query, i) and executes the prepared insert for i in [0, count),
+// committing every batchSize rows.
+template <typename BindRow>
+bool insertBatched(QSqlDatabase& db, const char* sql, int count, int batchSize, BindRow bindRow) {
+    QSqlQuery query(db);
+    if (!query.prepare(sql)) {
+        qDebug() << "ERROR:" << query.lastError().text();
+        return false;
+    }
+    for (int start = 0; start < count; start += batchSize) {
+        const int end = std::min(count, start + batchSize);
+        if (!db.transaction()) {
+            qDebug() << "ERROR:" << db.lastError().text();
+            return false;
+        }
+        for (int i = start; i < end; ++i) {
+            bindRow(query, i);
+            if (!query.exec()) {
+                qDebug() << "ERROR:" << query.lastError().text();
+                db.rollback();
+                return false;
+            }
+        }
+        if (!db.commit()) {
+            qDebug() << "ERROR:" << db.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool fillTables(QSqlDatabase& db, const DatasetSpec& spec) {
+    Random random(spec.seed);
+    const int batchSize = std::max(1, spec.batchSize);
+    const int items = std::max(0, spec.items);
+    const int patrons = std::max(0, spec.patrons);
+    const int firstPatronId = 3;
+    const QDate today = spec.today.isValid() ? spec.today : QDate::currentDate();
+
+    // --- Users ---
+    const bool usersOk = insertBatched(db, "INSERT INTO users (userid_, name_, role_) VALUES (?, ?, ?)",
+                                       patrons + 2, batchSize, [&](QSqlQuery& q, int i) {
+        const int userId = i + 1;
+        q.addBindValue(userId);
+        if (userId == 1) {
+            q.addBindValue("Librarian");
+            q.addBindValue("Librarian");
+        } else if (userId == 2) {
+            q.addBindValue("Admin");
+            q.addBindValue("Administrator");
+        } else {
+            // The number keeps names unique; findUserByName looks patrons up by exact name.
+            const QString given = pickFrom(random, GIVEN_NAMES);
+            const QString surname = pickFrom(random, SURNAMES);
+            q.addBindValue(QString("%1 %2 %3").arg(given, surname).arg(userId - firstPatronId + 1));
+            q.addBindValue("Patron");
+        }
+    });
+    if (!usersOk) return false;
+
+    // --- Loans: a random subset of items, spread round-robin over shuffled patrons ---
+    const int loanCount = patrons == 0 ? 0
+        : std::min({ std::max(0, spec.loans), items, patrons * LibrarySystem::MAX_ACTIVE_LOANS });
+
+    std::vector<int> itemOrder(items);
+    for (int i = 0; i < items; ++i) itemOrder[i] = i + 1;
+    for (int i = 0; i < loanCount; ++i) {
+        std::swap(itemOrder[i], itemOrder[i + random.below(items - i)]);
+    }
+    std::vector<int> patronOrder(patrons);
+    for (int i = 0; i < patrons; ++i) patronOrder[i] = firstPatronId + i;
+    for (int i = patrons - 1; i > 0; --i) {
+        std::swap(patronOrder[i], patronOrder[random.below(i + 1)]);
+    }
+
+    std::vector<int> loanerByItem(items + 1, 0);
+    for (int i = 0; i < loanCount; ++i) {
+        loanerByItem[itemOrder[i]] = patronOrder[i % patrons];
+    }
+
+    // --- Items ---
+    const bool itemsOk = insertBatched(db,
+        "INSERT INTO items (itemid_, title_, creator_, publicationYear_, kind_, dewey_, isbn_, "
+        "issueNumber_, publicationDate_, genre_, rating_, status_) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
+        items, batchSize, [&](QSqlQuery& q, int i) {
+        const int itemId = i + 1;
+        // One draw per statement: argument evaluation order is unspecified.
+        const int kind = pickKind(random, spec.kindWeights);
+        const int year = 1950 + random.below(76);
+        const QString title = makeTitle(random, kind);
+        const QString creator = makeCreator(random, kind);
+        const QVariant none(QVariant::String);
+        const QVariant noneInt(QVariant::Int);
+
+        q.addBindValue(itemId);
+        q.addBindValue(title);
+        q.addBindValue(creator);
+        q.addBindValue(year);
+        q.addBindValue(KINDS[kind]);
+        const int deweyClass = kind == 1 ? random.below(1000) : 0;
+        const int deweyDivision = kind == 1 ? random.below(100) : 0;
+        q.addBindValue(kind == 1 ? QVariant(QString("%1.%2").arg(deweyClass, 3, 10, QChar('0'))
+                                                       .arg(deweyDivision, 2, 10, QChar('0')))
+                                 : none);
+        q.addBindValue(kind <= 1 ? QVariant(QString("978%1").arg(itemId, 10, 10, QChar('0'))) : none);
+        q.addBindValue(kind == 2 ? QVariant(1 + random.below(200)) : noneInt);
+        q.addBindValue(kind == 2 ? QVariant(QDate(year, 1 + random.below(12), 1).toString("yyyy-MM-dd")) : none);
+        q.addBindValue(kind >= 3 ? QVariant(GENRES[random.below(6)]) : none);
+        q.addBindValue(kind >= 3 ? QVariant(RATINGS[random.below(7)]) : none);
+        q.addBindValue(loanerByItem[itemId] != 0 ? "CheckedOut" : "Available");
+    });
+    if (!itemsOk) return false;
+
+    const bool loansOk = insertBatched(db,
+        "INSERT INTO loans (userid_, itemid_, checkoutDate_, dueDate_) VALUES (?, ?, ?, ?)",
+        loanCount, batchSize, [&](QSqlQuery& q, int i) {
+        const int itemId = itemOrder[i];
+        // Up to one loan period in the past, so some loans are overdue.
+        const QDate checkout = today.addDays(-random.below(2 * LibrarySystem::LOAN_PERIOD_DAYS));
+        q.addBindValue(loanerByItem[itemId]);
+        q.addBindValue(itemId);
+        q.addBindValue(checkout.toString("yyyy-MM-dd"));
+        q.addBindValue(checkout.addDays(LibrarySystem::LOAN_PERIOD_DAYS).toString("yyyy-MM-dd"));
+    });
+    if (!loansOk) return false;
+
+    // --- Holds: on loaned items, never by the borrower, at most one per patron and item ---
+    // Popularity follows a Zipf law over the loaned items in their (random) loan order,
+    // so a few titles get long queues and most get none.
+    std::vector<std::pair<int, int>> holds;   // itemId, patronId
+    if (loanCount > 0 && patrons > 1) {
+        const ZipfSampler popularity(loanCount, std::max(0.0, spec.holdSkew));
+        std::unordered_set<std::uint64_t> taken;
+        const int wanted = std::max(0, spec.holds);
+        for (long long attempts = 0; static_cast<int>(holds.size()) < wanted && attempts < 10LL * wanted; ++attempts) {
+            const int itemId = itemOrder[popularity.draw(random)];
+            const int patronId = firstPatronId + random.below(patrons);
+            const std::uint64_t key = (static_cast<std::uint64_t>(itemId) << 32) | static_cast<std::uint32_t>(patronId);
+            if (patronId == loanerByItem[itemId] || !taken.insert(key).second) continue;
+            holds.emplace_back(itemId, patronId);
+        }
+        if (static_cast<int>(holds.size()) < wanted) {
+            qDebug() << "Dataset: placed" << holds.size() << "of" << wanted << "holds";
+        }
+    }
+
+    const bool holdsOk = insertBatched(db, "INSERT INTO holds (itemid_, userid_) VALUES (?, ?)",
+                                       static_cast<int>(holds.size()), batchSize, [&](QSqlQuery& q, int i) {
+        q.addBindValue(holds[i].first);
+        q.addBindValue(holds[i].second);
+    });
+    if (!holdsOk) return false;
+
+    // --- User activity: patron actions spread evenly over the year before today, in time order ---
+    const int activities = (patrons == 0 || items == 0) ? 0 : std::max(0, spec.activities);
+    const qint64 yearSeconds = 365LL * 24 * 60 * 60;
+    const qint64 meanStep = activities > 0 ? yearSeconds / activities : 0;
+    QDateTime when(today.addDays(-365), QTime(0, 0));
+    return insertBatched(db, "INSERT INTO useractivity (userid_, activity_, timestamp_) VALUES (?, ?, ?)",
+                         activities, batchSize, [&](QSqlQuery& q, int) {
+        const int patronId = firstPatronId + random.below(patrons);
+        const QString action = pickFrom(random, ACTIVITIES);
+        const int itemId = 1 + random.below(items);
+        when = when.addSecs(static_cast<qint64>(random.next() % static_cast<std::uint64_t>(2 * meanStep + 1)));
+        q.addBindValue(patronId);
+        q.addBindValue(action + QString::number(itemId));
+        q.addBindValue(when.toString("yyyy-MM-dd HH:mm:ss"));
+    });
+}
+
+} // namespace
+
+bool generateDataset(const QString& outputPath, const DatasetSpec& spec, const QString& schemaTemplatePath) {
+    if (QFile::exists(outputPath) && !QFile::remove(outputPath)) {
+        qDebug() << "ERROR: cannot replace" << outputPath;
+        return false;
+    }
+
+    bool ok = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", CONNECTION_NAME);
+        db.setDatabaseName(outputPath);
+        if (!db.open()) {
+            qDebug() << "ERROR: " << db.lastError();
+        } else {
+            // The file is rebuilt from scratch on failure, so skip durability while filling it.
+            QSqlQuery query(db);
+            query.exec("PRAGMA journal_mode = MEMORY");
+            query.exec("PRAGMA synchronous = OFF");
+            ok = copySchema(db, schemaTemplatePath) && fillTables(db, spec);
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(CONNECTION_NAME);
+    return ok;
+}
+
+} // namespace hinlibs
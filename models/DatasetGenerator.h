@@ -0,0 +1,31 @@
+#pragma once
+#include <QDate>
+#include <QString>
+#include <array>
+#include <cstdint>
+
+namespace hinlibs {
+
+// Row counts and shape of a synthetic database. The same spec always produces the same rows.
+struct DatasetSpec {
+    std::uint64_t seed = 1;
+    int items = 10000;
+    int patrons = 2000;
+    int loans = 3000;           // capped at items and at MAX_ACTIVE_LOANS per patron
+    int holds = 2000;           // placed on loaned items only, as placeHold requires
+    int activities = 0;         // useractivity rows
+    double holdSkew = 1.0;      // Zipf exponent of hold popularity over loaned items; 0 is uniform
+    // Relative share of FictionBook, NonFictionBook, Magazine, Movie, VideoGame.
+    std::array<int, 5> kindWeights = { 35, 30, 10, 15, 10 };
+    QDate today;                // loan and activity dates count back from here; invalid means today
+    int batchSize = 50000;      // rows per transaction
+};
+
+// Writes a fresh database to outputPath (replacing any existing file), with the tables of
+// schemaTemplatePath and rows generated from spec. User 1 is a librarian, user 2 an
+// administrator and the rest are patrons with unique names. Indexes and the search
+// index are left to runMigrations(), which LibrarySystem runs when it opens the file.
+bool generateDataset(const QString& outputPath, const DatasetSpec& spec,
+                     const QString& schemaTemplatePath = "db/hinlibs.sqlite3");
+
+} // namespace hinlibs
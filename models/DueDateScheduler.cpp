@@ -0,0 +1,84 @@
+#include "DueDateScheduler.h"
+#include <algorithm>
+
+namespace hinlibs {
+
+namespace {
+
+// std::push_heap keeps the largest element on top; this puts the earliest day there.
+struct LaterFirst {
+    template <typename Timer>
+    bool operator()(const Timer& a, const Timer& b) const { return a.fireDay > b.fireDay; }
+};
+
+} // namespace
+
+DueDateScheduler::DueDateScheduler(int dueSoonDays)
+    : dueSoonDays_(dueSoonDays), wheel_(WHEEL_DAYS) {}
+
+void DueDateScheduler::reset(std::int64_t today) {
+    today_ = today;
+    for (auto& slot : wheel_) slot.clear();
+    ready_.clear();
+    later_.clear();
+    live_.clear();
+}
+
+void DueDateScheduler::schedule(int itemId, std::int64_t dueDay) {
+    const std::uint32_t loan = nextLoan_++;
+    live_[itemId] = { dueDay, loan };
+    if (dueSoonDays_ > 0) insert({ dueDay - dueSoonDays_, itemId, loan, Event::DueSoon });
+    insert({ dueDay + 1, itemId, loan, Event::Overdue });
+}
+
+void DueDateScheduler::cancel(int itemId) {
+    live_.erase(itemId);
+}
+
+void DueDateScheduler::insert(const Timer& timer) {
+    if (timer.fireDay <= today_) {
+        ready_.push_back(timer);
+    } else if (timer.fireDay - today_ <= WHEEL_DAYS) {
+        wheel_[static_cast<std::size_t>(timer.fireDay % WHEEL_DAYS)].push_back(timer);
+    } else {
+        later_.push_back(timer);
+        std::push_heap(later_.begin(), later_.end(), LaterFirst());
+    }
+}
+
+void DueDateScheduler::fire(const Timer& timer, std::vector<Fired>& out) const {
+    auto live = live_.find(timer.itemId);
+    if (live == live_.end() || live->second.loan != timer.loan) return;   // returned or re-borrowed
+    out.push_back({ timer.event, timer.itemId, live->second.dueDay });
+}
+
+std::vector<DueDateScheduler::Fired> DueDateScheduler::advanceTo(std::int64_t today) {
+    std::vector<Fired> out;
+    for (const Timer& timer : ready_) fire(timer, out);
+    ready_.clear();
+    if (today <= today_) return out;
+
+    // Each slot holds exactly one day of the window, so at most WHEEL_DAYS slots are visited.
+    const std::int64_t last = std::min(today, today_ + WHEEL_DAYS);
+    for (std::int64_t day = today_ + 1; day <= last; ++day) {
+        auto& slot = wheel_[static_cast<std::size_t>(day % WHEEL_DAYS)];
+        for (const Timer& timer : slot) fire(timer, out);
+        slot.clear();
+    }
+    today_ = today;
+
+    // Bring timers within the new window onto the wheel; any already due fire now.
+    while (!later_.empty() && later_.front().fireDay - today_ <= WHEEL_DAYS) {
+        std::pop_heap(later_.begin(), later_.end(), LaterFirst());
+        const Timer timer = later_.back();
+        later_.pop_back();
+        if (timer.fireDay <= today_) {
+            fire(timer, out);
+        } else {
+            insert(timer);
+        }
+    }
+    return out;
+}
+
+} // namespace hinlibs
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace hinlibs {
+
+// Day-granularity timing wheel over loan due dates. Each loan gets two timers, due-soon
+// (dueSoonDays before the due day) and overdue (the day after it); advanceTo() fires
+// the timers whose day has come. Days are plain integers, e.g. QDate::toJulianDay().
+//
+// The wheel has one slot per day for the next WHEEL_DAYS days; later timers wait in a
+// min-heap and move onto the wheel as the clock approaches them. Advancing costs
+// O(fired timers + days crossed, at most WHEEL_DAYS), never O(all loans). Cancelling
+// is O(1): the loan is forgotten and its timers are dropped when they come up.
+//
+// Not synchronised; LibrarySystem guards it with its cache lock.
+class DueDateScheduler {
+public:
+    enum class Event { DueSoon, Overdue };
+    struct Fired {
+        Event event;
+        int itemId;
+        std::int64_t dueDay;
+    };
+
+    explicit DueDateScheduler(int dueSoonDays = 2);
+
+    // Empties the scheduler and sets its clock.
+    void reset(std::int64_t today);
+    // Replaces any loan already scheduled for the item. Timers whose day is already
+    // past fire on the next advanceTo().
+    void schedule(int itemId, std::int64_t dueDay);
+    void cancel(int itemId);
+    // Moves the clock forward to today and returns the events that came due. A loan's
+    // due-soon event always comes before its overdue event.
+    std::vector<Fired> advanceTo(std::int64_t today);
+
+    std::int64_t today() const noexcept { return today_; }
+    std::size_t size() const noexcept { return live_.size(); }
+
+private:
+    static constexpr std::int64_t WHEEL_DAYS = 64;
+
+    struct Timer {
+        std::int64_t fireDay;
+        int itemId;
+        std::uint32_t loan;
+        Event event;
+    };
+    struct Live {
+        std::int64_t dueDay;
+        std::uint32_t loan;
+    };
+
+    void insert(const Timer& timer);
+    void fire(const Timer& timer, std::vector<Fired>& out) const;
+
+    int dueSoonDays_;
+    std::int64_t today_ = 0;
+    std::uint32_t nextLoan_ = 1;
+    std::vector<std::vector<Timer>> wheel_;    // slot fireDay % WHEEL_DAYS, for today_ < fireDay <= today_ + WHEEL_DAYS
+    std::vector<Timer> ready_;                 // already due when scheduled
+    std::vector<Timer> later_;                 // min-heap on fireDay, beyond the wheel
+    std::unordered_map<int, Live> live_;       // itemId -> current loan; timers of other loans are stale
+};
+
+} // namespace hinlibs
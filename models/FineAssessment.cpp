@@ -0,0 +1,79 @@
+#include "FineAssessment.h"
+#include <algorithm>
+
+namespace hinlibs {
+
+namespace {
+
+constexpr qint64 UNIX_EPOCH_JULIAN_DAY = 2440588;
+
+// Days from 1970-01-01 in the proleptic Gregorian calendar (H. Hinnant's days_from_civil).
+qint64 daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const int yearOfEra = year - era * 400;
+    const int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return static_cast<qint64>(era) * 146097 + dayOfEra - 719468;
+}
+
+int digits(const QString& text, int from, int count, bool& ok) {
+    int value = 0;
+    for (int i = from; i < from + count; ++i) {
+        const int digit = text.at(i).unicode() - '0';
+        if (digit < 0 || digit > 9) ok = false;
+        value = value * 10 + digit;
+    }
+    return value;
+}
+
+} // namespace
+
+std::optional<qint64> julianDayFromIso(const QString& date) {
+    if (date.size() != 10 || date.at(4) != QLatin1Char('-') || date.at(7) != QLatin1Char('-')) return std::nullopt;
+    bool ok = true;
+    const int year = digits(date, 0, 4, ok);
+    const int month = digits(date, 5, 2, ok);
+    const int day = digits(date, 8, 2, ok);
+    if (!ok || month < 1 || month > 12 || day < 1 || day > 31) return std::nullopt;
+    return daysFromCivil(year, month, day) + UNIX_EPOCH_JULIAN_DAY;
+}
+
+int fineCents(int daysOverdue, const FinePolicy& policy) {
+    const qint64 chargeable = std::max(0, daysOverdue - policy.graceDays);
+    return static_cast<int>(std::min<qint64>(chargeable * policy.centsPerDay, policy.maxCentsPerLoan));
+}
+
+FineTally::FineTally(qint64 today, const FinePolicy& policy)
+    : today_(today), policy_(policy) {}
+
+bool FineTally::add(qint64 loanId, int patronId, int itemId, const QString& dueDate) {
+    const auto dueDay = julianDayFromIso(dueDate);
+    if (!dueDay) return false;
+    ++overdueLoans_;
+
+    const int daysOverdue = static_cast<int>(today_ - *dueDay);
+    const int cents = fineCents(daysOverdue, policy_);
+    if (cents <= 0) return true;
+
+    fines_.push_back({ loanId, patronId, itemId, daysOverdue, cents });
+    if (patrons_.empty() || patrons_.back().patronId != patronId) patrons_.push_back({ patronId, 0, 0 });
+    ++patrons_.back().fines;
+    patrons_.back().totalCents += cents;
+    totalCents_ += cents;
+    return true;
+}
+
+void FineTally::append(FineTally&& other) {
+    overdueLoans_ += other.overdueLoans_;
+    totalCents_ += other.totalCents_;
+    if (fines_.empty()) {
+        fines_ = std::move(other.fines_);
+        patrons_ = std::move(other.patrons_);
+        return;
+    }
+    fines_.insert(fines_.end(), other.fines_.begin(), other.fines_.end());
+    patrons_.insert(patrons_.end(), other.patrons_.begin(), other.patrons_.end());
+}
+
+} // namespace hinlibs
@@ -0,0 +1,70 @@
+#pragma once
+#include <QDate>
+#include <QString>
+#include <optional>
+#include <vector>
+
+namespace hinlibs {
+
+// A loan accrues centsPerDay for every day it is overdue beyond graceDays, up to maxCentsPerLoan.
+struct FinePolicy {
+    int centsPerDay = 25;
+    int graceDays = 0;
+    int maxCentsPerLoan = 1000;
+};
+
+// One row of the fines table.
+struct AssessedFine {
+    qint64 loanId;
+    int patronId;
+    int itemId;
+    int daysOverdue;
+    int cents;
+};
+
+struct PatronFines {
+    int patronId;
+    int fines;
+    qint64 totalCents;
+};
+
+struct FineReport {
+    QDate assessedOn;
+    qint64 overdueLoans = 0;            // loans read with dueDate_ before assessedOn
+    qint64 finesWritten = 0;
+    qint64 totalCents = 0;
+    std::vector<PatronFines> byPatron;  // patron id order; patrons owing nothing are left out
+    bool completed = false;             // false if the scan or the write failed; fines is then unchanged
+};
+
+// Julian day number (as QDate::toJulianDay) of a yyyy-MM-dd date, parsed without building a QDate.
+std::optional<qint64> julianDayFromIso(const QString& date);
+
+int fineCents(int daysOverdue, const FinePolicy& policy);
+
+// Turns a stream of overdue loans, grouped by patron, into fines and per-patron totals.
+// Dates are compared as day numbers, so each loan costs a parse and a subtraction.
+class FineTally {
+public:
+    FineTally(qint64 today, const FinePolicy& policy);
+
+    // Returns false, and skips the loan, if dueDate is not a yyyy-MM-dd date.
+    bool add(qint64 loanId, int patronId, int itemId, const QString& dueDate);
+    // Moves other's results onto the end; all of other's patrons must come after this tally's.
+    void append(FineTally&& other);
+
+    qint64 overdueLoans() const noexcept { return overdueLoans_; }
+    qint64 totalCents() const noexcept { return totalCents_; }
+    const std::vector<AssessedFine>& fines() const noexcept { return fines_; }
+    const std::vector<PatronFines>& patrons() const noexcept { return patrons_; }
+
+private:
+    qint64 today_;
+    FinePolicy policy_;
+    qint64 overdueLoans_ = 0;
+    qint64 totalCents_ = 0;
+    std::vector<AssessedFine> fines_;
+    std::vector<PatronFines> patrons_;
+};
+
+} // namespace hinlibs
@@ -0,0 +1,165 @@
+#include "HoldQueues.h"
+#include <algorithm>
+
+namespace hinlibs {
+
+namespace {
+
+// Compacting costs a pass over the queue, so wait until removed holds outnumber queued ones.
+constexpr std::size_t MIN_REMOVED_BEFORE_COMPACT = 16;
+
+std::size_t lowestBit(std::size_t index) { return index & (~index + 1); }
+
+} // namespace
+
+// --- HoldQueues::Queue ---
+
+void HoldQueues::Queue::push(int holdId, int patronId) {
+    holds_.push_back({ holdId, patronId, true });
+    // Node i covers holds (i - lowestBit(i), i]; all but the new one are already counted.
+    const std::size_t node = holds_.size();
+    tree_.push_back(1 + queuedThrough(node - 1) - queuedThrough(node - lowestBit(node)));
+}
+
+void HoldQueues::Queue::erase(std::size_t index) {
+    holds_[index].queued = false;
+    ++removed_;
+    for (std::size_t node = index + 1; node <= tree_.size(); node += lowestBit(node)) --tree_[node - 1];
+    while (front_ < holds_.size() && !holds_[front_].queued) ++front_;
+    if (removed_ >= MIN_REMOVED_BEFORE_COMPACT && removed_ > size()) compact();
+}
+
+std::optional<std::size_t> HoldQueues::Queue::find(int holdId) const {
+    auto at = std::lower_bound(holds_.begin(), holds_.end(), holdId,
+                               [](const QueuedHold& h, int id) { return h.holdId < id; });
+    if (at == holds_.end() || at->holdId != holdId || !at->queued) return std::nullopt;
+    return static_cast<std::size_t>(at - holds_.begin());
+}
+
+int HoldQueues::Queue::queuedThrough(std::size_t count) const {
+    int queued = 0;
+    for (std::size_t node = count; node > 0; node -= lowestBit(node)) queued += tree_[node - 1];
+    return queued;
+}
+
+void HoldQueues::Queue::compact() {
+    holds_.erase(std::remove_if(holds_.begin(), holds_.end(), [](const QueuedHold& h) { return !h.queued; }),
+                 holds_.end());
+    // Every hold is queued again, so node i counts lowestBit(i) holds.
+    tree_.resize(holds_.size());
+    for (std::size_t node = 1; node <= tree_.size(); ++node) tree_[node - 1] = static_cast<int>(lowestBit(node));
+    front_ = 0;
+    removed_ = 0;
+}
+
+// --- HoldQueues ---
+
+void HoldQueues::clear() {
+    queues_.clear();
+    byPatron_.clear();
+    size_ = 0;
+}
+
+bool HoldQueues::add(int itemId, int patronId, int holdId) {
+    if (contains(itemId, patronId)) return false;
+    auto& queue = queues_[itemId];
+    if (!queue.holds().empty() && queue.holds().back().holdId >= holdId) {
+        if (queue.size() == 0) queues_.erase(itemId);
+        return false;
+    }
+
+    queue.push(holdId, patronId);
+    byPatron_[patronId].push_back({ holdId, itemId });
+    ++size_;
+    return true;
+}
+
+bool HoldQueues::remove(int itemId, int patronId) {
+    auto patron = byPatron_.find(patronId);
+    if (patron == byPatron_.end()) return false;
+    auto& held = patron->second;
+    auto mine = std::find_if(held.begin(), held.end(), [itemId](const HeldItem& h) { return h.itemId == itemId; });
+    if (mine == held.end()) return false;
+
+    auto queue = queues_.find(itemId);
+    if (queue != queues_.end()) {
+        if (const auto index = queue->second.find(mine->holdId)) queue->second.erase(*index);
+        if (queue->second.size() == 0) queues_.erase(queue);
+    }
+
+    held.erase(mine);
+    if (held.empty()) byPatron_.erase(patron);
+    --size_;
+    return true;
+}
+
+std::size_t HoldQueues::removeItem(int itemId) {
+    auto queue = queues_.find(itemId);
+    if (queue == queues_.end()) return 0;
+
+    const std::size_t removed = queue->second.size();
+    for (const QueuedHold& hold : queue->second.holds()) {
+        if (!hold.queued) continue;
+        auto patron = byPatron_.find(hold.patronId);
+        if (patron == byPatron_.end()) continue;
+        auto& held = patron->second;
+        held.erase(std::remove_if(held.begin(), held.end(), [itemId](const HeldItem& h) { return h.itemId == itemId; }),
+                   held.end());
+        if (held.empty()) byPatron_.erase(patron);
+    }
+    queues_.erase(queue);
+    size_ -= removed;
+    return removed;
+}
+
+bool HoldQueues::hasHolds(int itemId) const {
+    return queues_.count(itemId) > 0;
+}
+
+bool HoldQueues::contains(int itemId, int patronId) const {
+    return holdIdOf(itemId, patronId).has_value();
+}
+
+std::optional<int> HoldQueues::head(int itemId) const {
+    auto queue = queues_.find(itemId);
+    if (queue == queues_.end()) return std::nullopt;
+    return queue->second.front().patronId;
+}
+
+int HoldQueues::position(int itemId, int patronId) const {
+    const auto holdId = holdIdOf(itemId, patronId);
+    if (!holdId) return 0;
+    auto queue = queues_.find(itemId);
+    if (queue == queues_.end()) return 0;
+    return positionOf(queue->second, *holdId);
+}
+
+std::vector<HoldQueues::PatronHold> HoldQueues::holdsOf(int patronId) const {
+    std::vector<PatronHold> out;
+    auto patron = byPatron_.find(patronId);
+    if (patron == byPatron_.end()) return out;
+
+    out.reserve(patron->second.size());
+    for (const HeldItem& held : patron->second) {
+        auto queue = queues_.find(held.itemId);
+        if (queue == queues_.end()) continue;
+        out.push_back({ held.itemId, positionOf(queue->second, held.holdId) });
+    }
+    return out;
+}
+
+std::optional<int> HoldQueues::holdIdOf(int itemId, int patronId) const {
+    auto patron = byPatron_.find(patronId);
+    if (patron == byPatron_.end()) return std::nullopt;
+    for (const HeldItem& held : patron->second) {
+        if (held.itemId == itemId) return held.holdId;
+    }
+    return std::nullopt;
+}
+
+int HoldQueues::positionOf(const Queue& queue, int holdId) {
+    const auto index = queue.find(holdId);
+    return index ? queue.position(*index) : 0;
+}
+
+} // namespace hinlibs
@@ -0,0 +1,83 @@
+#pragma once
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace hinlibs {
+
+// In-memory copy of the holds table: one FIFO queue per item, ordered by holdid_, and
+// each patron's holds in the order they were placed.
+//
+//   head / hasHolds / contains      O(1) (contains scans the patron's few holds)
+//   position                        O(log n) binary search on holdid_, then a Fenwick prefix sum
+//   add                             O(log n); new holds always join the back
+//   remove                          O(log n) amortised; the hold is marked removed in place and
+//                                   the queue is compacted once most of it is removed
+//
+// Not synchronised; LibrarySystem guards it with its cache lock.
+class HoldQueues {
+public:
+    struct PatronHold {
+        int itemId;
+        int queuePosition;      // 1 is next in line
+    };
+
+    void clear();
+    // holdId must be larger than any hold already queued for the item, as AUTOINCREMENT ids are.
+    bool add(int itemId, int patronId, int holdId);
+    bool remove(int itemId, int patronId);
+    // Drops the item's queue; returns how many holds it had.
+    std::size_t removeItem(int itemId);
+
+    bool hasHolds(int itemId) const;
+    bool contains(int itemId, int patronId) const;
+    std::optional<int> head(int itemId) const;
+    // 1-based place of the patron in the item's queue, or 0 if the patron has no hold on it.
+    int position(int itemId, int patronId) const;
+    // The patron's holds, oldest first.
+    std::vector<PatronHold> holdsOf(int patronId) const;
+    std::size_t size() const noexcept { return size_; }
+
+private:
+    struct QueuedHold {
+        int holdId;
+        int patronId;
+        bool queued;            // false once removed, until the queue is compacted
+    };
+    // Holds in holdId order, removed ones included, with a Fenwick tree over the queued
+    // flags so a hold's place in line is a prefix count rather than a scan.
+    class Queue {
+    public:
+        void push(int holdId, int patronId);
+        // Marks holds[index] removed; may compact, which invalidates indexes.
+        void erase(std::size_t index);
+        std::optional<std::size_t> find(int holdId) const;
+        // 1-based place among the queued holds of the queued hold at index.
+        int position(std::size_t index) const { return queuedThrough(index + 1); }
+        const QueuedHold& front() const { return holds_[front_]; }
+        std::size_t size() const noexcept { return holds_.size() - removed_; }
+        const std::vector<QueuedHold>& holds() const noexcept { return holds_; }
+
+    private:
+        int queuedThrough(std::size_t count) const;   // queued holds among the first count
+        void compact();
+
+        std::vector<QueuedHold> holds_;
+        std::vector<int> tree_;                        // Fenwick tree, tree_[i - 1] for node i
+        std::size_t front_ = 0;                        // first queued hold
+        std::size_t removed_ = 0;
+    };
+    struct HeldItem {
+        int holdId;
+        int itemId;
+    };
+
+    std::optional<int> holdIdOf(int itemId, int patronId) const;
+    static int positionOf(const Queue& queue, int holdId);
+
+    std::unordered_map<int, Queue> queues_;                     // itemId -> holds, ascending holdId
+    std::unordered_map<int, std::vector<HeldItem>> byPatron_;   // patronId -> holds, ascending holdId
+    std::size_t size_ = 0;
+};
+
+} // namespace hinlibs
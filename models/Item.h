@@ -1,11 +1,12 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <QQueue>
 #include <QDate>
 
 namespace hinlibs {
 
-enum class ItemStatus { Available, CheckedOut};
+enum class ItemStatus : std::uint8_t { Available, CheckedOut };
 enum class ItemKind   { Book, Movie, VideoGame, Magazine };
 
 class Item {
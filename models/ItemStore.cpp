@@ -0,0 +1,397 @@
+#include "ItemStore.h"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <QDebug>
+
+namespace hinlibs {
+
+namespace {
+
+const char* const KIND_NAMES[] = { "FictionBook", "NonFictionBook", "Magazine", "Movie", "VideoGame" };
+
+} // namespace
+
+std::optional<CatalogueKind> catalogueKindFromName(std::string_view name) {
+    for (std::size_t k = 0; k < std::size(KIND_NAMES); ++k) {
+        if (name == KIND_NAMES[k]) return static_cast<CatalogueKind>(k);
+    }
+    return std::nullopt;
+}
+
+const char* catalogueKindName(CatalogueKind kind) {
+    return KIND_NAMES[static_cast<std::size_t>(kind)];
+}
+
+// --- TextPool ---
+
+bool TextPool::add(std::string_view text, TextRef& ref) {
+    const std::uint64_t capacity = blockStarts_.size() * BLOCK_SIZE;
+    if (used_ + text.size() > capacity) {
+        // Start a new allocation; the rest of the current block is left unused.
+        const std::size_t blocks = std::max<std::size_t>(1, (text.size() + BLOCK_SIZE - 1) / BLOCK_SIZE);
+        if (capacity + blocks * BLOCK_SIZE > TextRef::NONE) return false;
+        allocations_.push_back(std::make_unique<char[]>(blocks * BLOCK_SIZE));
+        for (std::size_t b = 0; b < blocks; ++b) {
+            blockStarts_.push_back(allocations_.back().get() + b * BLOCK_SIZE);
+        }
+        used_ = capacity;
+    }
+
+    ref.offset = static_cast<std::uint32_t>(used_);
+    ref.length = static_cast<std::uint32_t>(text.size());
+    if (!text.empty()) std::memcpy(blockStarts_[used_ / BLOCK_SIZE] + used_ % BLOCK_SIZE, text.data(), text.size());
+    used_ += text.size();
+    return true;
+}
+
+std::string_view TextPool::get(TextRef ref) const {
+    if (ref.length == TextRef::NONE) return {};
+    if (ref.length == 0) return std::string_view("", 0);
+    return { blockStarts_[ref.offset / BLOCK_SIZE] + ref.offset % BLOCK_SIZE, ref.length };
+}
+
+// --- StringDictionary ---
+
+bool StringDictionary::intern(std::string_view text, TextPool& pool, std::uint32_t& code) {
+    auto it = codes_.find(text);
+    if (it != codes_.end()) {
+        code = it->second;
+        return true;
+    }
+    TextRef ref;
+    if (refs_.size() >= maxCode_ || !pool.add(text, ref)) return false;
+    refs_.push_back(ref);
+    code = static_cast<std::uint32_t>(refs_.size());
+    codes_.emplace(pool.get(ref), code);
+    return true;
+}
+
+std::optional<std::uint32_t> StringDictionary::codeOf(std::string_view text) const {
+    auto it = codes_.find(text);
+    if (it == codes_.end()) return std::nullopt;
+    return it->second;
+}
+
+std::string_view StringDictionary::text(std::uint32_t code, const TextPool& pool) const {
+    if (code == NONE) return {};
+    return pool.get(refs_[code - 1]);
+}
+
+std::size_t StringDictionary::memoryUsage() const noexcept {
+    // Node-based map: one node (key, code, hash, next pointer) per value plus the bucket array.
+    return refs_.capacity() * sizeof(TextRef)
+         + codes_.size() * (sizeof(std::string_view) + 2 * sizeof(void*) + sizeof(std::uint32_t))
+         + codes_.bucket_count() * sizeof(void*);
+}
+
+// --- ItemView ---
+
+ItemKind ItemView::kind() const noexcept {
+    switch (kind_) {
+    case CatalogueKind::Magazine: return ItemKind::Magazine;
+    case CatalogueKind::Movie: return ItemKind::Movie;
+    case CatalogueKind::VideoGame: return ItemKind::VideoGame;
+    default: return ItemKind::Book;
+    }
+}
+
+bool ItemView::isBook() const noexcept {
+    return kind_ == CatalogueKind::FictionBook || kind_ == CatalogueKind::NonFictionBook;
+}
+
+std::optional<std::string_view> ItemView::optional(std::string_view text, bool applies) {
+    if (!applies || text.data() == nullptr) return std::nullopt;
+    return text;
+}
+
+std::optional<std::string_view> ItemView::dewey() const { return optional(first_, isBook()); }
+std::optional<std::string_view> ItemView::isbn() const { return optional(second_, isBook()); }
+std::optional<std::string_view> ItemView::genre() const { return optional(first_, !isBook() && kind_ != CatalogueKind::Magazine); }
+std::optional<std::string_view> ItemView::rating() const { return optional(second_, !isBook() && kind_ != CatalogueKind::Magazine); }
+
+std::optional<int> ItemView::issueNumber() const {
+    if (kind_ != CatalogueKind::Magazine || issueNumber_ == INT32_MIN) return std::nullopt;
+    return issueNumber_;
+}
+
+QDate ItemView::publicationDate() const {
+    if (kind_ != CatalogueKind::Magazine || publicationDay_ == INT32_MIN) return QDate();
+    return QDate::fromJulianDay(publicationDay_);
+}
+
+std::string_view ItemView::typeName() const noexcept {
+    switch (kind_) {
+    case CatalogueKind::FictionBook: return "Fiction Book";
+    case CatalogueKind::NonFictionBook: return "Non-Fiction Book";
+    case CatalogueKind::Magazine: return "Magazine";
+    case CatalogueKind::Movie: return "Movie";
+    case CatalogueKind::VideoGame: return "Video Game";
+    }
+    return {};
+}
+
+std::string ItemView::detailsSummary() const {
+    std::ostringstream oss;
+    switch (kind_) {
+    case CatalogueKind::FictionBook:
+    case CatalogueKind::NonFictionBook:
+        oss << "Book Title: " << title_
+            << " | Author: " << creator_
+            << " | Publication Year: " << publicationYear_
+            << " | Book Type:  " << typeName();
+        if (kind_ == CatalogueKind::NonFictionBook && dewey()) oss << " | Dewey: " << *dewey();
+        if (isbn()) oss << " | ISBN: " << *isbn();
+        break;
+    case CatalogueKind::Magazine:
+        oss << "Title: " << title_
+            << " | Publisher: " << creator_
+            << " | Publication Year: " << publicationYear_
+            << " | Issue#: " << issueNumber().value_or(-1)
+            << " | Publication Date: " << publicationDate().toString("yyyy-MM-dd").toStdString();
+        break;
+    case CatalogueKind::Movie:
+    case CatalogueKind::VideoGame:
+        oss << "Title: " << title_
+            << (kind_ == CatalogueKind::Movie ? " | Director: " : " | Studio: ") << creator_
+            << " | Publication Year: " << publicationYear_
+            << " | Genre: " << genre().value_or("")
+            << " | Rating: " << rating().value_or("");
+        break;
+    }
+    return oss.str();
+}
+
+// --- ItemStore ---
+
+ItemStore::ItemStore() : text_(std::make_shared<TextPool>()) {}
+
+void ItemStore::reserve(std::size_t items) {
+    slotById_.reserve(items + 1);
+    ids_.reserve(items);
+    kinds_.reserve(items);
+    statuses_.reserve(items);
+    years_.reserve(items);
+    titles_.reserve(items);
+    creators_.reserve(items);
+    deweys_.reserve(items);
+    isbns_.reserve(items);
+    genres_.reserve(items);
+    ratings_.reserve(items);
+    issueNumbers_.reserve(items);
+    publicationDays_.reserve(items);
+}
+
+bool ItemStore::append(int itemId, const ItemInDB& row) {
+    const auto kind = catalogueKindFromName(row.kind_);
+    if (!kind) return false;
+    if (itemId <= 0 || slotOf(itemId)) {
+        qDebug() << "ERROR: item" << itemId << "cannot be added to the item store";
+        return false;
+    }
+
+    const bool book = *kind == CatalogueKind::FictionBook || *kind == CatalogueKind::NonFictionBook;
+    const bool magazine = *kind == CatalogueKind::Magazine;
+
+    TextRef title, dewey, isbn;
+    std::uint32_t creator = StringDictionary::NONE;
+    std::uint32_t genre = StringDictionary::NONE;
+    std::uint32_t rating = StringDictionary::NONE;
+    const bool stored = text_->add(row.title_, title)
+        && creatorCodes_.intern(row.creator_, *text_, creator)
+        && (!book || !row.dewey_ || text_->add(*row.dewey_, dewey))
+        && (!book || !row.isbn_ || text_->add(*row.isbn_, isbn))
+        && (book || magazine || !row.genre_ || genreCodes_.intern(*row.genre_, *text_, genre))
+        && (book || magazine || !row.rating_ || ratingCodes_.intern(*row.rating_, *text_, rating));
+    if (!stored) {
+        qDebug() << "ERROR: item text pool or dictionary is full";
+        return false;
+    }
+
+    std::int32_t issue = NO_NUMBER;
+    std::int32_t day = NO_NUMBER;
+    if (magazine) {
+        if (row.issueNumber_) issue = *row.issueNumber_;
+        if (row.publicationDate_ && row.publicationDate_->isValid()) {
+            day = static_cast<std::int32_t>(row.publicationDate_->toJulianDay());
+        }
+    }
+
+    if (static_cast<std::size_t>(itemId) >= slotById_.size()) {
+        slotById_.resize(static_cast<std::size_t>(itemId) + 1, NO_SLOT);
+    }
+    slotById_[static_cast<std::size_t>(itemId)] = static_cast<std::uint32_t>(ids_.size());
+    ids_.push_back(itemId);
+    kinds_.push_back(*kind);
+    statuses_.push_back(row.status_);
+    years_.push_back(row.publicationYear_);
+    titles_.push_back(title);
+    creators_.push_back(creator);
+    deweys_.push_back(dewey);
+    isbns_.push_back(isbn);
+    genres_.push_back(static_cast<std::uint16_t>(genre));
+    ratings_.push_back(static_cast<std::uint16_t>(rating));
+    issueNumbers_.push_back(issue);
+    publicationDays_.push_back(day);
+    return true;
+}
+
+bool ItemStore::remove(int itemId) {
+    const auto slot = slotOf(itemId);
+    if (!slot) return false;
+    // Fill the gap with the last slot instead of shifting every column down.
+    const auto moveLast = [at = *slot](auto& column) {
+        column[at] = column.back();
+        column.pop_back();
+    };
+    moveLast(ids_);
+    moveLast(kinds_);
+    moveLast(statuses_);
+    moveLast(years_);
+    moveLast(titles_);
+    moveLast(creators_);
+    moveLast(deweys_);
+    moveLast(isbns_);
+    moveLast(genres_);
+    moveLast(ratings_);
+    moveLast(issueNumbers_);
+    moveLast(publicationDays_);
+    if (*slot < ids_.size()) slotById_[static_cast<std::size_t>(ids_[*slot])] = static_cast<std::uint32_t>(*slot);
+    slotById_[static_cast<std::size_t>(itemId)] = NO_SLOT;
+    return true;
+}
+
+bool ItemStore::setStatus(int itemId, ItemStatus status) {
+    const auto slot = slotOf(itemId);
+    if (!slot) return false;
+    statuses_[*slot] = status;
+    return true;
+}
+
+std::optional<std::size_t> ItemStore::slotOf(int itemId) const {
+    if (itemId <= 0 || static_cast<std::size_t>(itemId) >= slotById_.size()) return std::nullopt;
+    const std::uint32_t slot = slotById_[static_cast<std::size_t>(itemId)];
+    if (slot == NO_SLOT) return std::nullopt;
+    return slot;
+}
+
+ItemView ItemStore::view(std::size_t slot) const {
+    ItemView v;
+    v.text_ = text_;
+    v.title_ = text_->get(titles_[slot]);
+    v.creator_ = creatorCodes_.text(creators_[slot], *text_);
+    const bool book = kinds_[slot] == CatalogueKind::FictionBook || kinds_[slot] == CatalogueKind::NonFictionBook;
+    v.first_ = book ? text_->get(deweys_[slot]) : genreCodes_.text(genres_[slot], *text_);
+    v.second_ = book ? text_->get(isbns_[slot]) : ratingCodes_.text(ratings_[slot], *text_);
+    v.id_ = ids_[slot];
+    v.publicationYear_ = years_[slot];
+    v.issueNumber_ = issueNumbers_[slot];
+    v.publicationDay_ = publicationDays_[slot];
+    v.kind_ = kinds_[slot];
+    v.status_ = statuses_[slot];
+    return v;
+}
+
+ItemView ItemStore::find(int itemId) const {
+    const auto slot = slotOf(itemId);
+    return slot ? view(*slot) : ItemView();
+}
+
+std::vector<ItemView> ItemStore::viewsAfter(int afterItemId, std::size_t limit,
+                                            std::optional<CatalogueKind> kind,
+                                            std::optional<ItemStatus> status) const {
+    std::vector<ItemView> out;
+    out.reserve(std::min(limit, size()));
+    for (std::size_t id = static_cast<std::size_t>(std::max(afterItemId, 0)) + 1;
+         id < slotById_.size() && out.size() < limit; ++id) {
+        const std::uint32_t slot = slotById_[id];
+        if (slot == NO_SLOT) continue;
+        if (kind && kinds_[slot] != *kind) continue;
+        if (status && statuses_[slot] != *status) continue;
+        out.push_back(view(slot));
+    }
+    return out;
+}
+
+std::uint32_t ItemStore::facetCode(ItemFacet facet, std::size_t slot) const {
+    switch (facet) {
+    case ItemFacet::Kind: return static_cast<std::uint32_t>(kinds_[slot]) + 1;
+    case ItemFacet::Creator: return creators_[slot];
+    case ItemFacet::Genre: return genres_[slot];
+    case ItemFacet::Rating: return ratings_[slot];
+    }
+    return StringDictionary::NONE;
+}
+
+std::uint32_t ItemStore::facetCodeCount(ItemFacet facet) const {
+    switch (facet) {
+    case ItemFacet::Kind: return static_cast<std::uint32_t>(std::size(KIND_NAMES));
+    case ItemFacet::Creator: return creatorCodes_.size();
+    case ItemFacet::Genre: return genreCodes_.size();
+    case ItemFacet::Rating: return ratingCodes_.size();
+    }
+    return 0;
+}
+
+std::string_view ItemStore::facetText(ItemFacet facet, std::uint32_t code) const {
+    switch (facet) {
+    case ItemFacet::Kind: return KIND_NAMES[code - 1];
+    case ItemFacet::Creator: return creatorCodes_.text(code, *text_);
+    case ItemFacet::Genre: return genreCodes_.text(code, *text_);
+    case ItemFacet::Rating: return ratingCodes_.text(code, *text_);
+    }
+    return {};
+}
+
+std::optional<std::uint32_t> ItemStore::facetCodeOf(ItemFacet facet, std::string_view value) const {
+    switch (facet) {
+    case ItemFacet::Kind: {
+        const auto kind = catalogueKindFromName(value);
+        if (!kind) return std::nullopt;
+        return static_cast<std::uint32_t>(*kind) + 1;
+    }
+    case ItemFacet::Creator: return creatorCodes_.codeOf(value);
+    case ItemFacet::Genre: return genreCodes_.codeOf(value);
+    case ItemFacet::Rating: return ratingCodes_.codeOf(value);
+    }
+    return std::nullopt;
+}
+
+std::vector<std::pair<std::string_view, std::size_t>> ItemStore::facetCounts(ItemFacet facet) const {
+    std::vector<std::size_t> counts(facetCodeCount(facet) + 1, 0);
+    for (std::size_t slot = 0; slot < size(); ++slot) ++counts[facetCode(facet, slot)];
+
+    std::vector<std::pair<std::string_view, std::size_t>> out;
+    for (std::uint32_t code = 1; code < counts.size(); ++code) {
+        if (counts[code] > 0) out.emplace_back(facetText(facet, code), counts[code]);
+    }
+    std::stable_sort(out.begin(), out.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+    return out;
+}
+
+std::vector<std::size_t> ItemStore::slotsWith(ItemFacet facet, std::string_view value, std::size_t limit) const {
+    std::vector<std::size_t> out;
+    const auto code = facetCodeOf(facet, value);
+    if (!code) return out;
+    for (std::size_t id = 1; id < slotById_.size() && out.size() < limit; ++id) {
+        const std::uint32_t slot = slotById_[id];
+        if (slot != NO_SLOT && facetCode(facet, slot) == *code) out.push_back(slot);
+    }
+    return out;
+}
+
+std::size_t ItemStore::memoryUsage() const noexcept {
+    return ids_.capacity() * sizeof(std::int32_t)
+         + kinds_.capacity() * sizeof(CatalogueKind)
+         + statuses_.capacity() * sizeof(ItemStatus)
+         + years_.capacity() * sizeof(std::int32_t)
+         + (titles_.capacity() + deweys_.capacity() + isbns_.capacity()) * sizeof(TextRef)
+         + creators_.capacity() * sizeof(std::uint32_t)
+         + (genres_.capacity() + ratings_.capacity()) * sizeof(std::uint16_t)
+         + (issueNumbers_.capacity() + publicationDays_.capacity()) * sizeof(std::int32_t)
+         + slotById_.capacity() * sizeof(std::uint32_t)
+         + text_->bytesAllocated()
+         + creatorCodes_.memoryUsage() + genreCodes_.memoryUsage() + ratingCodes_.memoryUsage();
+}
+
+} // namespace hinlibs
@@ -0,0 +1,207 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <QDate>
+
+#include "Item.h"
+#include "itemInDB.h"
+
+namespace hinlibs {
+
+// items.kind_ values. Finer than ItemKind, which does not tell fiction from non-fiction.
+enum class CatalogueKind : std::uint8_t { FictionBook, NonFictionBook, Magazine, Movie, VideoGame };
+
+std::optional<CatalogueKind> catalogueKindFromName(std::string_view name);
+const char* catalogueKindName(CatalogueKind kind);
+
+// Position of a string in a TextPool. A length of NONE marks a NULL column.
+struct TextRef {
+    static constexpr std::uint32_t NONE = 0xFFFFFFFFu;
+    std::uint32_t offset = 0;
+    std::uint32_t length = NONE;
+};
+
+// Append-only string storage in 1 MiB blocks. Blocks never move, so views into the
+// pool stay valid for as long as the pool itself. Holds at most 4 GiB of text.
+class TextPool {
+public:
+    // Returns false if the pool is full.
+    bool add(std::string_view text, TextRef& ref);
+    // A NULL ref gives a view with a null data() pointer; an empty string does not.
+    std::string_view get(TextRef ref) const;
+    std::size_t bytesAllocated() const noexcept { return blockStarts_.size() * BLOCK_SIZE; }
+
+private:
+    static constexpr std::size_t BLOCK_SIZE = std::size_t{1} << 20;
+
+    std::vector<std::unique_ptr<char[]>> allocations_;
+    std::vector<char*> blockStarts_;        // block index -> address; a long string takes several adjacent blocks
+    std::uint64_t used_ = 0;                // offset of the next free byte
+};
+
+// Interns a repeating field (creators, genres, ratings): each distinct value is stored
+// once in a TextPool and named by a small integer code, so equal values compare as
+// integers. Code 0 is NULL. Codes are never reused while the dictionary lives.
+class StringDictionary {
+public:
+    static constexpr std::uint32_t NONE = 0;
+
+    explicit StringDictionary(std::uint32_t maxCode = UINT32_MAX - 1) : maxCode_(maxCode) {}
+
+    // Returns false if the pool is full or the dictionary has maxCode values.
+    bool intern(std::string_view text, TextPool& pool, std::uint32_t& code);
+    std::optional<std::uint32_t> codeOf(std::string_view text) const;
+    std::string_view text(std::uint32_t code, const TextPool& pool) const;
+    // Highest code handed out so far.
+    std::uint32_t size() const noexcept { return static_cast<std::uint32_t>(refs_.size()); }
+    std::size_t memoryUsage() const noexcept;
+
+private:
+    std::uint32_t maxCode_;
+    std::vector<TextRef> refs_;                                  // code - 1 -> text
+    std::unordered_map<std::string_view, std::uint32_t> codes_;  // keys point into the pool
+};
+
+// Fields that hold few distinct values, for counting and filtering by code.
+enum class ItemFacet { Kind, Creator, Genre, Rating };
+
+// Snapshot of one catalogue row, taken under the cache lock. Copying it does not
+// allocate; its strings point into the store's TextPool, which the view keeps alive
+// across reloads. Status changes after the snapshot arrive as ItemChange::Updated.
+class ItemView {
+public:
+    ItemView() = default;
+    explicit operator bool() const noexcept { return id_ != 0; }
+
+    int id() const noexcept { return id_; }
+    CatalogueKind catalogueKind() const noexcept { return kind_; }
+    ItemKind kind() const noexcept;
+    ItemStatus status() const noexcept { return status_; }
+    int publicationYear() const noexcept { return publicationYear_; }
+    std::string_view title() const noexcept { return title_; }
+    std::string_view creator() const noexcept { return creator_; }
+
+    // Books: dewey and isbn. Movies and video games: genre and rating. Magazines: issue and date.
+    std::optional<std::string_view> dewey() const;
+    std::optional<std::string_view> isbn() const;
+    std::optional<std::string_view> genre() const;
+    std::optional<std::string_view> rating() const;
+    std::optional<int> issueNumber() const;
+    QDate publicationDate() const;
+
+    // Same text as the Item subclasses produce; typeName() is a literal, not a new string.
+    std::string_view typeName() const noexcept;
+    std::string detailsSummary() const;
+
+private:
+    friend class ItemStore;
+
+    std::shared_ptr<const TextPool> text_;
+    std::string_view title_;
+    std::string_view creator_;
+    std::string_view first_;                // dewey or genre; null data() if NULL
+    std::string_view second_;               // isbn or rating
+    int id_ = 0;
+    int publicationYear_ = 0;
+    std::int32_t issueNumber_ = 0;
+    std::int32_t publicationDay_ = 0;       // Julian day
+    CatalogueKind kind_ = CatalogueKind::FictionBook;
+    ItemStatus status_ = ItemStatus::Available;
+
+    bool isBook() const noexcept;
+    static std::optional<std::string_view> optional(std::string_view text, bool applies);
+};
+
+// Columnar in-memory catalogue: one packed array per field, indexed by slot, with every
+// string in a shared TextPool. Lookups by id go through a dense id -> slot array, so they
+// take constant time; item ids come from AUTOINCREMENT and have few gaps. Removing an
+// item moves the last slot into its place, so slots are not in id order.
+// Creators, genres and ratings are dictionary codes, so each distinct value is stored
+// once and filtering on them compares integers.
+//
+// Per item this costs 54 bytes of columns and index plus the title, Dewey and ISBN text:
+// about 95 bytes for a typical row, against about 300 for the make_shared Item subclass,
+// its strings, the shared_ptr and the id -> slot hash entry it replaces. Text of removed
+// items stays in the pool until the next reload.
+//
+// Not synchronised; LibrarySystem guards it with its cache lock.
+class ItemStore {
+public:
+    ItemStore();
+    ItemStore(ItemStore&&) noexcept = default;
+    ItemStore& operator=(ItemStore&&) noexcept = default;
+    ItemStore(const ItemStore&) = delete;
+    ItemStore& operator=(const ItemStore&) = delete;
+
+    std::size_t size() const noexcept { return ids_.size(); }
+    bool empty() const noexcept { return ids_.empty(); }
+    void reserve(std::size_t items);
+
+    // Returns false if itemId is not positive or already stored, for an unknown kind,
+    // or when the text pool is full.
+    bool append(int itemId, const ItemInDB& row);
+    // Constant time: the last slot moves into the removed one.
+    bool remove(int itemId);
+    bool setStatus(int itemId, ItemStatus status);
+
+    std::optional<std::size_t> slotOf(int itemId) const;
+    ItemView view(std::size_t slot) const;
+    ItemView find(int itemId) const;
+    // Up to limit items with id > afterItemId, in id order, optionally only those of one
+    // kind and/or status. The filters compare the columns, so skipped items cost no view.
+    std::vector<ItemView> viewsAfter(int afterItemId, std::size_t limit,
+                                     std::optional<CatalogueKind> kind = std::nullopt,
+                                     std::optional<ItemStatus> status = std::nullopt) const;
+
+    // Columns, indexed by slot; slots are in no particular order.
+    const std::vector<std::int32_t>& ids() const noexcept { return ids_; }
+    const std::vector<CatalogueKind>& kinds() const noexcept { return kinds_; }
+    const std::vector<ItemStatus>& statuses() const noexcept { return statuses_; }
+    const std::vector<std::int32_t>& publicationYears() const noexcept { return years_; }
+    std::string_view title(std::size_t slot) const { return text_->get(titles_[slot]); }
+    std::string_view creator(std::size_t slot) const { return creatorCodes_.text(creators_[slot], *text_); }
+
+    // Distinct values of a facet with their item counts, most common first; NULLs are skipped.
+    std::vector<std::pair<std::string_view, std::size_t>> facetCounts(ItemFacet facet) const;
+    // Slots whose facet equals value, in item id order; empty if no item has that value.
+    std::vector<std::size_t> slotsWith(ItemFacet facet, std::string_view value, std::size_t limit) const;
+
+    // Bytes held by the columns and the text pool.
+    std::size_t memoryUsage() const noexcept;
+
+private:
+    std::vector<std::int32_t> ids_;
+    std::vector<CatalogueKind> kinds_;
+    std::vector<ItemStatus> statuses_;
+    std::vector<std::int32_t> years_;
+    std::vector<TextRef> titles_;
+    std::vector<std::uint32_t> creators_;        // creatorCodes_
+    std::vector<TextRef> deweys_;                // books only
+    std::vector<TextRef> isbns_;
+    std::vector<std::uint16_t> genres_;          // genreCodes_; movies and video games only
+    std::vector<std::uint16_t> ratings_;         // ratingCodes_
+    std::vector<std::int32_t> issueNumbers_;     // magazines; NO_NUMBER otherwise
+    std::vector<std::int32_t> publicationDays_;  // magazines, as Julian days; NO_NUMBER otherwise
+    std::vector<std::uint32_t> slotById_;        // item id -> slot, NO_SLOT where there is no item
+    std::shared_ptr<TextPool> text_;
+    StringDictionary creatorCodes_;
+    StringDictionary genreCodes_{UINT16_MAX};
+    StringDictionary ratingCodes_{UINT16_MAX};
+
+    static constexpr std::int32_t NO_NUMBER = INT32_MIN;
+    static constexpr std::uint32_t NO_SLOT = UINT32_MAX;
+
+    // Code of each slot for a facet (kinds are stored one above their enum value).
+    std::uint32_t facetCode(ItemFacet facet, std::size_t slot) const;
+    std::uint32_t facetCodeCount(ItemFacet facet) const;
+    std::string_view facetText(ItemFacet facet, std::uint32_t code) const;
+    std::optional<std::uint32_t> facetCodeOf(ItemFacet facet, std::string_view value) const;
+};
+
+} // namespace hinlibs
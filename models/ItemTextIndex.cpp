@@ -0,0 +1,160 @@
+#include "ItemTextIndex.h"
+#include <algorithm>
+#include <mutex>
+
+namespace hinlibs {
+
+namespace {
+
+// Byte -> its lower-case form, or 0 for a byte that separates words.
+struct FoldTable {
+    char fold[256];
+    constexpr FoldTable() : fold() {
+        for (int c = 0; c < 256; ++c) {
+            const bool digit = c >= '0' && c <= '9';
+            const bool lower = c >= 'a' && c <= 'z';
+            const bool upper = c >= 'A' && c <= 'Z';
+            fold[c] = upper ? static_cast<char>(c - 'A' + 'a') : (digit || lower || c >= 0x80) ? static_cast<char>(c) : 0;
+        }
+    }
+};
+constexpr FoldTable FOLD;
+
+} // namespace
+
+// Lower-cases ASCII letters and turns punctuation into single spaces; out must be non-empty.
+void ItemTextIndex::appendNormalized(std::string& out, std::string_view s) {
+    for (unsigned char c : s) {
+        const char folded = FOLD.fold[c];
+        if (folded) {
+            out += folded;
+        } else if (out.back() != ' ') {
+            out += ' ';
+        }
+    }
+}
+
+// With a leading space so every word start is preceded by one,
+// e.g. "The Silent-Forest" -> " the silent forest".
+std::string ItemTextIndex::normalize(std::string_view s) {
+    std::string out(1, ' ');
+    out.reserve(s.size() + 1);
+    appendNormalized(out, s);
+    return out;
+}
+
+// Same as normalize(title + " " + creator), reusing out's buffer.
+void ItemTextIndex::normalizeItem(std::string_view title, std::string_view creator, std::string& out) {
+    out.assign(1, ' ');
+    appendNormalized(out, title);
+    if (out.back() != ' ') out += ' ';
+    appendNormalized(out, creator);
+}
+
+std::vector<std::uint32_t> ItemTextIndex::trigramsOf(const std::string& normalized) {
+    std::vector<std::uint32_t> grams;
+    if (normalized.size() < 3) return grams;
+    grams.reserve(normalized.size() - 2);
+    for (std::size_t i = 0; i + 2 < normalized.size(); ++i) {
+        grams.push_back(static_cast<std::uint32_t>(static_cast<unsigned char>(normalized[i])) << 16
+                      | static_cast<std::uint32_t>(static_cast<unsigned char>(normalized[i + 1])) << 8
+                      | static_cast<std::uint32_t>(static_cast<unsigned char>(normalized[i + 2])));
+    }
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+void ItemTextIndex::build(const ItemStore& items) {
+    std::unique_lock lock(mutex_);
+    postings_.clear();
+    std::string text;
+    for (std::size_t slot = 0; slot < items.size(); ++slot) {
+        normalizeItem(items.title(slot), items.creator(slot), text);
+        addLocked(items.ids()[slot], text);
+    }
+}
+
+void ItemTextIndex::add(int itemId, std::string_view title, std::string_view creator) {
+    std::string text;
+    normalizeItem(title, creator, text);
+    std::unique_lock lock(mutex_);
+    addLocked(itemId, text);
+}
+
+void ItemTextIndex::addLocked(int itemId, const std::string& text) {
+    for (std::uint32_t gram : trigramsOf(text)) {
+        auto& ids = postings_[gram];
+        // Ids arrive in ascending order on load and insert, so this is almost always a push_back.
+        if (ids.empty() || ids.back() < itemId) {
+            ids.push_back(itemId);
+        } else {
+            auto pos = std::lower_bound(ids.begin(), ids.end(), itemId);
+            if (pos == ids.end() || *pos != itemId) ids.insert(pos, itemId);
+        }
+    }
+}
+
+void ItemTextIndex::remove(int itemId, std::string_view title, std::string_view creator) {
+    std::string text;
+    normalizeItem(title, creator, text);
+    std::unique_lock lock(mutex_);
+    for (std::uint32_t gram : trigramsOf(text)) {
+        auto list = postings_.find(gram);
+        if (list == postings_.end()) continue;
+        auto& ids = list->second;
+        auto pos = std::lower_bound(ids.begin(), ids.end(), itemId);
+        if (pos != ids.end() && *pos == itemId) ids.erase(pos);
+        if (ids.empty()) postings_.erase(list);
+    }
+}
+
+std::vector<int> ItemTextIndex::search(const std::string& text, std::size_t limit, const ItemStore& items,
+                                       const CancelCheck& cancelled) const {
+    std::vector<int> out;
+
+    // normalize() adds the leading word-boundary space; keep it only for two-character input.
+    std::string needle = normalize(text);
+    while (needle.size() > 1 && needle.back() == ' ') needle.pop_back();
+    if (needle.size() < 3) return out;
+    if (needle.size() > 3) needle.erase(0, 1);
+
+    const auto grams = trigramsOf(needle);
+
+    std::shared_lock lock(mutex_);
+
+    std::vector<const std::vector<int>*> lists;
+    lists.reserve(grams.size());
+    for (std::uint32_t gram : grams) {
+        auto it = postings_.find(gram);
+        if (it == postings_.end()) return out;
+        lists.push_back(&it->second);
+    }
+    // Walk the rarest trigram and probe the others.
+    std::sort(lists.begin(), lists.end(),
+              [](const std::vector<int>* a, const std::vector<int>* b) { return a->size() < b->size(); });
+
+    std::size_t visited = 0;
+    std::string candidate;
+    for (int itemId : *lists.front()) {
+        if (cancelled && (++visited & 0x3FF) == 0 && cancelled()) break;
+
+        bool inAll = true;
+        for (std::size_t i = 1; i < lists.size() && inAll; ++i) {
+            inAll = std::binary_search(lists[i]->begin(), lists[i]->end(), itemId);
+        }
+        if (!inAll) continue;
+
+        // Trigrams can match out of order, so confirm the substring.
+        const auto slot = items.slotOf(itemId);
+        if (!slot) continue;
+        normalizeItem(items.title(*slot), items.creator(*slot), candidate);
+        if (candidate.find(needle) == std::string::npos) continue;
+
+        out.push_back(itemId);
+        if (out.size() >= limit) break;
+    }
+    return out;
+}
+
+} // namespace hinlibs
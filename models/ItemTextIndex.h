@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "ItemStore.h"
+
+namespace hinlibs {
+
+// In-memory trigram index over item titles and creators, used for search-as-you-type.
+// Searches may run on worker threads while the owning thread adds or removes items.
+// The index holds only the posting lists; the text itself stays in the ItemStore.
+class ItemTextIndex {
+public:
+    using CancelCheck = std::function<bool()>;
+
+    void build(const ItemStore& items);
+    void add(int itemId, std::string_view title, std::string_view creator);
+    // title and creator must be the ones the item was added with.
+    void remove(int itemId, std::string_view title, std::string_view creator);
+
+    // Ids (ascending) of items whose title or creator contains text, ignoring case.
+    // Two characters match the start of a word; anything shorter matches nothing.
+    // Trigram matches are confirmed against items, which the caller must keep from
+    // changing for the duration. If cancelled() turns true the search stops and
+    // returns what it has so far.
+    std::vector<int> search(const std::string& text, std::size_t limit, const ItemStore& items,
+                            const CancelCheck& cancelled = {}) const;
+
+private:
+    static void appendNormalized(std::string& out, std::string_view s);
+    static std::string normalize(std::string_view s);
+    static void normalizeItem(std::string_view title, std::string_view creator, std::string& out);
+    static std::vector<std::uint32_t> trigramsOf(const std::string& normalized);
+    void addLocked(int itemId, const std::string& text);
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::uint32_t, std::vector<int>> postings_;  // trigram -> sorted item ids
+};
+
+} // namespace hinlibs
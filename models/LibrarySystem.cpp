@@ -1,29 +1,118 @@
 #include "LibrarySystem.h"
+#include "Migrations.h"
 #include <algorithm>
 #include <QDebug>
+#include <QtConcurrent>
 #include <functional>
+#include <iterator>
+#include <sstream>
 namespace hinlibs {
 
-LibrarySystem::LibrarySystem() {
-    db_ = QSqlDatabase::addDatabase("QSQLITE");
-    db_.setDatabaseName("db/hinlibs.sqlite3");
+namespace {
+
+// Turns free text into an FTS5 query of quoted prefix terms so user input can't
+// produce FTS syntax errors, e.g.  silent for  ->  "silent"* "for"*
+std::string toFtsMatch(const std::string& text) {
+    std::istringstream words(text);
+    std::string word;
+    std::string match;
+    while (words >> word) {
+        std::string quoted;
+        for (char c : word) {
+            if (c == '"') quoted += '"';
+            quoted += c;
+        }
+        if (!match.empty()) match += ' ';
+        match += '"' + quoted + "\"*";
+    }
+    return match;
+}
+
+const char* const INSERT_ITEM_SQL =
+    "INSERT INTO items (kind_, title_, creator_, publicationYear_, dewey_, isbn_, "
+    "issueNumber_, publicationDate_, genre_, rating_, status_) "
+    "VALUES (:kind_, :title_, :creator_, :publicationYear_, :dewey_, :isbn_, "
+    ":issueNumber_, :publicationDate_, :genre_, :rating_, :status_)";
+
+// Binds an ItemInDB to the placeholders of INSERT_ITEM_SQL.
+void bindItemValues(QSqlQuery& query, const ItemInDB& item, ItemStatus status) {
+    auto optionalText = [](const std::optional<std::string>& value) {
+        return value.has_value() ? QVariant(QString::fromStdString(value.value())) : QVariant(QVariant::String);
+    };
+
+    query.bindValue(":kind_", QString::fromStdString(item.kind_));
+    query.bindValue(":title_", QString::fromStdString(item.title_));
+    query.bindValue(":creator_", QString::fromStdString(item.creator_));
+    query.bindValue(":publicationYear_", item.publicationYear_);
+    query.bindValue(":dewey_", optionalText(item.dewey_));
+    query.bindValue(":isbn_", optionalText(item.isbn_));
+    query.bindValue(":issueNumber_", item.issueNumber_.has_value() ? QVariant(item.issueNumber_.value()) : QVariant(QVariant::Int));
+    query.bindValue(":publicationDate_", item.publicationDate_.has_value()
+                                             ? QVariant(item.publicationDate_.value().toString("yyyy-MM-dd"))
+                                             : QVariant(QVariant::String));
+    query.bindValue(":genre_", optionalText(item.genre_));
+    query.bindValue(":rating_", optionalText(item.rating_));
+    query.bindValue(":status_", status == ItemStatus::Available ? "Available" : "CheckedOut");
+}
 
+} // namespace
 
-    if (!db_.open()) {
-        qDebug() << "ERROR: " << db_.lastError();
+LibrarySystem::LibrarySystem(const QString& databasePath, const DatabaseProfile& profile,
+                             const ActivityLogOptions& activityLog)
+    : profile_(profile),
+      pool_(databasePath, MAX_READ_CONNECTIONS, profile_.pragmas(), profile_.readOnlyPragmas()) {
+    fineScanThreads_.setMaxThreadCount(MAX_FINE_THREADS);
+    fineScanThreads_.setExpiryTimeout(-1);
+    QSqlDatabase db = pool_.connection();
+
+    if (!db.isOpen()) {
+        qDebug() << "ERROR: " << db.lastError();
         return;
     } else {
         qDebug() << "Working";
     }
+    DatabaseProfile::logEffectiveSettings(db, profile_.name);
+
+    if (!runMigrations(db)) {
+        qDebug() << "ERROR: schema migration failed";
+    }
 
     getUsersFromDB();
     getItemsFromDB();
+    getHoldsFromDB();
+    getLoansFromDB();
+
+    activityLog_ = std::make_unique<ActivityLogger>(pool_, activityLog);
+}
+
+// Statements on the checkout path are compiled once per thread, on its read-write
+// connection, and re-bound per call. The pool drops them when the thread exits.
+LibrarySystem::CheckoutStatements& LibrarySystem::checkoutStatements() {
+    return pool_.attachment<CheckoutStatements>([this]() {
+        QSqlDatabase db = pool_.connection();
+        auto statements = std::make_unique<CheckoutStatements>();
+        statements->checkoutItem = QSqlQuery(db);
+        statements->checkoutItem.prepare(
+            "UPDATE items SET status_ = 'CheckedOut' "
+            "WHERE itemid_ = :itemId AND status_ = 'Available' "
+            "AND NOT EXISTS (SELECT 1 FROM loans WHERE itemid_ = :loanItemId)"
+        );
+
+        statements->consumeHold = QSqlQuery(db);
+        statements->consumeHold.prepare("DELETE FROM holds WHERE itemid_ = :itemId AND userid_ = :patronId");
+
+        statements->insertLoan = QSqlQuery(db);
+        statements->insertLoan.prepare("INSERT INTO loans (userid_, itemid_, checkoutDate_, dueDate_) "
+                                       "VALUES (:patronId, :itemId, :checkoutDate_, :dueDate_)");
+        return statements.release();
+    });
 }
 
 // --- DB operation ---
 
 void LibrarySystem::getUsersFromDB(){
-    QSqlQuery query;
+    QSqlDatabase db = pool_.connection(ConnectionPool::Access::ReadOnly);
+    QSqlQuery query(db);
     query.prepare("SELECT * FROM users");
 
     if (!query.exec()) {
@@ -52,9 +141,16 @@ void LibrarySystem::getUsersFromDB(){
 }
 
 void LibrarySystem::getItemsFromDB() {
-    items_.clear();
-    QSqlQuery query;
-    query.prepare("SELECT * FROM items");
+    QSqlDatabase db = pool_.connection(ConnectionPool::Access::ReadOnly);
+    ItemStore items;
+    QSqlQuery count(db);
+    if (count.exec("SELECT COUNT(*) FROM items") && count.next()) {
+        items.reserve(count.value(0).toUInt());
+    }
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    // items_ stays sorted by id: loaded in id order, appended with AUTOINCREMENT ids, erased in place.
+    query.prepare("SELECT * FROM items ORDER BY itemid_ ASC");
 
     if (!query.exec()) {
         qDebug() << "ERROR:" << query.lastError().text();
@@ -62,83 +158,232 @@ void LibrarySystem::getItemsFromDB() {
         while (query.next()) {
 
             int itemid_ = query.value("itemid_").toInt();
-            std::string kind_ = query.value("kind_").toString().toStdString();
-            std::string title_ = query.value("title_").toString().toStdString();
-            std::string creator_ = query.value("creator_").toString().toStdString();
-            int publicationYear_ = query.value("publicationYear_").toInt();
 
-            std::optional<std::string> dewey_ = std::nullopt;
+            ItemInDB row;
+            row.kind_ = query.value("kind_").toString().toStdString();
+            row.title_ = query.value("title_").toString().toStdString();
+            row.creator_ = query.value("creator_").toString().toStdString();
+            row.publicationYear_ = query.value("publicationYear_").toInt();
+
             QVariant deweyVal = query.value("dewey_");
             if (!deweyVal.isNull()) {
-                dewey_ = deweyVal.toString().toStdString();
+                row.dewey_ = deweyVal.toString().toStdString();
             }
 
-            std::optional<std::string> isbn_ = std::nullopt;
             QVariant isbnVal = query.value("isbn_");
             if (!isbnVal.isNull()) {
-                isbn_ = isbnVal.toString().toStdString();
+                row.isbn_ = isbnVal.toString().toStdString();
             }
 
-            int issueNumber_ = -1;
             QVariant issueNumberVal = query.value("issueNumber_");
             if (!issueNumberVal.isNull()) {
-                issueNumber_ = issueNumberVal.toInt();
+                row.issueNumber_ = issueNumberVal.toInt();
             }
 
-            QDate publicationDate_;
             QVariant publicationDateVal = query.value("publicationDate_");
             if (!publicationDateVal.isNull()) {
                 QString pubString_ = publicationDateVal.toString();
-                publicationDate_ = QDate::fromString(pubString_, "yyyy-MM-dd");
+                row.publicationDate_ = QDate::fromString(pubString_, "yyyy-MM-dd");
             }
 
-            std::string genre_ = "";
             QVariant genreVal = query.value("genre_");
             if (!genreVal.isNull()) {
-                genre_ = genreVal.toString().toStdString();
+                row.genre_ = genreVal.toString().toStdString();
             }
 
-            std::string rating_ = "";
             QVariant ratingVal = query.value("rating_");
             if (!ratingVal.isNull()) {
-                rating_ = ratingVal.toString().toStdString();
+                row.rating_ = ratingVal.toString().toStdString();
             }
 
             std::string status_ = query.value("status_").toString().toStdString();
-            ItemStatus itemStatus;
             if (status_ == "CheckedOut") {
-                itemStatus = ItemStatus::CheckedOut;
+                row.status_ = ItemStatus::CheckedOut;
             } else {
-                itemStatus = ItemStatus::Available;
+                row.status_ = ItemStatus::Available;
             }
 
-            if (kind_ == "FictionBook") {
+            items.append(itemid_, row);
+        }
+    }
+    textIndex_.build(items);
 
-                items_.push_back(std::make_shared<Book>(itemid_, title_, creator_, publicationYear_,BookType::Fiction, dewey_, isbn_, itemStatus));
+    {
+        std::unique_lock lock(cacheMutex_);
+        std::swap(items_, items);
+    }
+    notifyItemChanged(ItemChange::Reloaded, 0);
+}
 
-            } else if (kind_ == "NonFictionBook") {
+void LibrarySystem::getHoldsFromDB() {
+    QSqlDatabase db = pool_.connection(ConnectionPool::Access::ReadOnly);
+    HoldQueues holds;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    // holdid_ order, so every queue is built front to back.
+    query.prepare("SELECT holdid_, itemid_, userid_ FROM holds ORDER BY holdid_ ASC");
 
-                items_.push_back(std::make_shared<Book>(itemid_, title_, creator_, publicationYear_, BookType::NonFiction, dewey_, isbn_, itemStatus));
+    if (!query.exec()) {
+        qDebug() << "ERROR:" << query.lastError().text();
+    } else {
+        while (query.next()) {
+            const int holdId = query.value(0).toInt();
+            if (!holds.add(query.value(1).toInt(), query.value(2).toInt(), holdId)) {
+                qDebug() << "ERROR: hold" << holdId << "duplicates an earlier hold and was not queued";
+            }
+        }
+    }
 
-            } else if (kind_ == "Magazine") {
+    std::unique_lock lock(cacheMutex_);
+    std::swap(holds_, holds);
+}
 
-                items_.push_back(std::make_shared<Magazine>(itemid_, title_, creator_, publicationYear_, issueNumber_, publicationDate_, itemStatus));
+void LibrarySystem::getLoansFromDB() {
+    QSqlDatabase db = pool_.connection(ConnectionPool::Access::ReadOnly);
+    std::unordered_map<int, Loan> loans;
+    std::unordered_map<int, int> activeLoans;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT itemid_, userid_, checkoutDate_, dueDate_ FROM loans ORDER BY loanid_ ASC");
 
-            } else if (kind_ == "Movie") {
+    if (!query.exec()) {
+        qDebug() << "ERROR:" << query.lastError().text();
+    } else {
+        while (query.next()) {
+            Loan loan;
+            loan.itemId = query.value(0).toInt();
+            loan.patronId = query.value(1).toInt();
+            loan.checkout = QDate::fromString(query.value(2).toString(), "yyyy-MM-dd");
+            loan.due = QDate::fromString(query.value(3).toString(), "yyyy-MM-dd");
+            ++activeLoans[loan.patronId];
+            if (!loans.emplace(loan.itemId, loan).second) {
+                qDebug() << "ERROR: item" << loan.itemId << "has more than one loan";
+            }
+        }
+    }
 
-                items_.push_back(std::make_shared<Movie>(itemid_, title_, creator_, publicationYear_, genre_, rating_, itemStatus));
+    std::unique_lock lock(cacheMutex_);
+    // Consistency check: a loan needs an item that is CheckedOut, and a CheckedOut item needs a loan.
+    for (const auto& [itemId, loan] : loans) {
+        const auto slot = items_.slotOf(itemId);
+        if (!slot) {
+            qDebug() << "ERROR: loan of patron" << loan.patronId << "is for missing item" << itemId;
+        } else if (items_.statuses()[*slot] != ItemStatus::CheckedOut) {
+            qDebug() << "ERROR: item" << itemId << "is on loan but not CheckedOut";
+        }
+    }
+    for (std::size_t slot = 0; slot < items_.size(); ++slot) {
+        if (items_.statuses()[slot] == ItemStatus::CheckedOut && loans.count(items_.ids()[slot]) == 0) {
+            qDebug() << "ERROR: item" << items_.ids()[slot] << "is CheckedOut without a loan";
+        }
+    }
+    for (const auto& [patronId, count] : activeLoans) {
+        if (count > MAX_ACTIVE_LOANS) {
+            qDebug() << "ERROR: patron" << patronId << "has" << count << "loans, over the limit of" << MAX_ACTIVE_LOANS;
+        }
+    }
+    loansByItemId_.swap(loans);
+    activeLoansByPatron_.swap(activeLoans);
+
+    // Loans already past a boundary fire at once, so standings are right from the start.
+    const QDate today = QDate::currentDate();
+    dueDates_.reset(today.toJulianDay());
+    overdueItemsByPatron_.clear();
+    for (const auto& [itemId, loan] : loansByItemId_) {
+        if (loan.due.isValid()) dueDates_.schedule(itemId, loan.due.toJulianDay());
+    }
+    applyDueDateEvents(dueDates_.advanceTo(today.toJulianDay()));
+}
 
-            } else if (kind_ == "VideoGame") {
+// items_ is kept write-through by every mutation below, so reads never touch the database.
+const ItemStore& LibrarySystem::allItems() const {
+    return items_;
+}
 
-                items_.push_back(std::make_shared<VideoGame>(itemid_, title_, creator_, publicationYear_, genre_, rating_, itemStatus));
-            }
+int LibrarySystem::addItemChangeListener(ItemChangeListener listener) {
+    std::lock_guard lock(listenersMutex_);
+    const int listenerId = nextListenerId_++;
+    itemChangeListeners_[listenerId] = std::move(listener);
+    return listenerId;
+}
+
+void LibrarySystem::removeItemChangeListener(int listenerId) {
+    std::lock_guard lock(listenersMutex_);
+    itemChangeListeners_.erase(listenerId);
+}
+
+void LibrarySystem::notifyItemChanged(ItemChange change, int itemId) const {
+    std::lock_guard lock(listenersMutex_);
+    for (const auto& entry : itemChangeListeners_) {
+        entry.second(change, itemId);
+    }
+}
+
+std::vector<ItemView> LibrarySystem::itemsAfter(int afterItemId, std::size_t limit,
+                                                std::optional<CatalogueKind> kind,
+                                                std::optional<ItemStatus> status) const {
+    std::shared_lock lock(cacheMutex_);
+    return items_.viewsAfter(afterItemId, limit, kind, status);
+}
+
+std::vector<ItemView> LibrarySystem::searchCatalogue(const CatalogueSearch& search) const {
+    QSqlDatabase db = pool_.connection(ConnectionPool::Access::ReadOnly);
+    std::vector<ItemView> out;
+
+    const std::string match = toFtsMatch(search.text);
+    if (match.empty()) return out;
+
+    QString sql =
+        "SELECT i.itemid_ FROM items_fts "
+        "JOIN items i ON i.itemid_ = items_fts.rowid "
+        "WHERE items_fts MATCH :match";
+    if (search.kind) sql += " AND i.kind_ = :kind";
+    if (search.status) sql += " AND i.status_ = :status";
+    // Column weights: title, creator, isbn, genre, dewey.
+    sql += " ORDER BY bm25(items_fts, 10.0, 5.0, 1.0, 2.0, 1.0) LIMIT :limit OFFSET :offset";
+
+    QSqlQuery query1(db);
+    query1.setForwardOnly(true);
+    query1.prepare(sql);
+    query1.bindValue(":match", QString::fromStdString(match));
+    if (search.kind) query1.bindValue(":kind", QString::fromStdString(*search.kind));
+    if (search.status) {
+        query1.bindValue(":status", *search.status == ItemStatus::CheckedOut ? "CheckedOut" : "Available");
+    }
+    query1.bindValue(":limit", search.limit);
+    query1.bindValue(":offset", search.offset);
+
+    if (!query1.exec()) {
+        qDebug() << "ERROR:" << query1.lastError().text();
+        return out;
+    }
+
+    while (query1.next()) {
+        if (auto item = getItemById(query1.value(0).toInt())) {
+            out.push_back(std::move(item));
         }
     }
+    return out;
 }
 
-const std::vector<std::shared_ptr<Item>>& LibrarySystem::allItems(){
-    getItemsFromDB();
-    return items_;
+std::vector<int> LibrarySystem::suggestItemIds(const std::string& text, std::size_t limit,
+                                               const ItemTextIndex::CancelCheck& cancelled) const {
+    std::shared_lock lock(cacheMutex_);
+    return textIndex_.search(text, limit, items_, cancelled);
+}
+
+std::vector<std::pair<std::string, std::size_t>> LibrarySystem::facetCounts(ItemFacet facet) const {
+    std::shared_lock lock(cacheMutex_);
+    std::vector<std::pair<std::string, std::size_t>> out;
+    for (const auto& [value, count] : items_.facetCounts(facet)) out.emplace_back(value, count);
+    return out;
+}
+
+std::vector<ItemView> LibrarySystem::itemsWithFacet(ItemFacet facet, const std::string& value, std::size_t limit) const {
+    std::shared_lock lock(cacheMutex_);
+    std::vector<ItemView> out;
+    for (std::size_t slot : items_.slotsWith(facet, value, limit)) out.push_back(items_.view(slot));
+    return out;
 }
 
 std::shared_ptr<User> LibrarySystem::findUserByName(const std::string& name) const {
@@ -157,142 +402,153 @@ std::shared_ptr<Patron> LibrarySystem::getPatronById(int patronId) const {
     return std::static_pointer_cast<Patron>(it->second);
 }
 
-std::shared_ptr<Item> LibrarySystem::getItemById(int itemId) const {
-
-    for (auto& it : items_) {
-        if (it->id() == itemId) return it;
-    }
-    return nullptr;
+ItemView LibrarySystem::getItemById(int itemId) const {
+    std::shared_lock lock(cacheMutex_);
+    return items_.find(itemId);
 }
 
 // --- Patron operations ---
 
 bool LibrarySystem::borrowItem(int patronId, int itemId) {
 
-    if (countLoansForPatron(patronId) >= MAX_ACTIVE_LOANS) return false;
-
-    QSqlQuery query1;
+    if (!getPatronById(patronId)) return false;
+
+    bool consumesHold = false;
+    {
+        // While an item has holds, only the patron at the head of the queue may borrow it.
+        std::unique_lock lock(cacheMutex_);
+        const auto head = holds_.head(itemId);
+        if (head && *head != patronId) return false;
+        consumesHold = head.has_value();
+        // Counted now, so concurrent borrows by one patron can't all pass the limit;
+        // given back below if the checkout doesn't commit.
+        if (!reserveLoanSlot(patronId)) return false;
+    }
 
-    query1.prepare("SELECT * FROM users WHERE userid_ = :patronId");
-    query1.bindValue(":patronId", patronId);
-    if (!query1.exec() || !query1.next()) return false;
-    if(query1.value("role_").toString().toStdString() != "Patron") return false;
+    const QDate checkoutDate = QDate::currentDate();
+    const QDate dueDate = checkoutDate.addDays(LOAN_PERIOD_DAYS);
 
+    // Everything in here commits or rolls back together, so an item can never be
+    // left CheckedOut without its loan row.
+    const bool committed = [&]() {
+        QSqlDatabase db = pool_.connection();
+        CheckoutStatements& statements = checkoutStatements();
 
+        if (!db.transaction()) {
+            qDebug() << "ERROR:" << db.lastError().text();
+            return false;
+        }
 
-    QSqlQuery query2;
-    query2.prepare("SELECT * FROM items WHERE itemid_ = :itemId");
-    query2.bindValue(":itemId", itemId);
-    if (!query2.exec() || !query2.next()) return false;
-    if(query2.value("status_").toString().toStdString() != "Available") return false;
-
-    QSqlQuery query3;
-    query3.prepare("SELECT * FROM holds WHERE itemid_ = :itemId ORDER BY holdid_ ASC");
-    query3.bindValue(":itemId", itemId);
-    if(!query3.exec()) return false;
-    if (query3.next()) {
-        if (query3.value("userid_").toInt() != patronId) {
+        statements.checkoutItem.bindValue(":itemId", itemId);
+        statements.checkoutItem.bindValue(":loanItemId", itemId);
+        if (!statements.checkoutItem.exec() || statements.checkoutItem.numRowsAffected() != 1) {
+            // Unavailable or already on loan.
+            db.rollback();
             return false;
         }
-        QSqlQuery query4;
-        query4.prepare("DELETE FROM holds WHERE itemid_ = :itemId AND userid_ = :patronId");
-        query4.bindValue(":itemId", itemId);
-        query4.bindValue(":patronId", patronId);
-        if (!query4.exec()) return false;
 
-    }
+        if (consumesHold) {
+            statements.consumeHold.bindValue(":itemId", itemId);
+            statements.consumeHold.bindValue(":patronId", patronId);
+            if (!statements.consumeHold.exec()) {
+                qDebug() << "ERROR:" << statements.consumeHold.lastError().text();
+                db.rollback();
+                return false;
+            }
+        }
 
-    QSqlQuery query5;
-    query5.prepare("SELECT * FROM loans WHERE itemid_ = :itemId AND userid_ = :patronId");
-    query5.bindValue(":itemId", itemId);
-    query5.bindValue(":patronId", patronId);
+        statements.insertLoan.bindValue(":patronId", patronId);
+        statements.insertLoan.bindValue(":itemId", itemId);
+        statements.insertLoan.bindValue(":checkoutDate_", checkoutDate.toString("yyyy-MM-dd"));
+        statements.insertLoan.bindValue(":dueDate_", dueDate.toString("yyyy-MM-dd"));
+        if (!statements.insertLoan.exec()) {
+            qDebug() << "ERROR:" << statements.insertLoan.lastError().text();
+            db.rollback();
+            return false;
+        }
 
-    if (!query5.exec()) return false;
+        if (!db.commit()) {
+            qDebug() << "ERROR:" << db.lastError().text();
+            db.rollback();
+            return false;
+        }
+        return true;
+    }();
 
-    if (query5.next()) {
-        return false; // Cannot borrow the same item twice
+    {
+        std::unique_lock lock(cacheMutex_);
+        if (!committed) {
+            releaseLoanSlot(patronId);
+            return false;
+        }
+        items_.setStatus(itemId, ItemStatus::CheckedOut);
+        if (consumesHold) holds_.remove(itemId, patronId);
+        loansByItemId_[itemId] = Loan{ itemId, patronId, checkoutDate, dueDate };
+        dueDates_.schedule(itemId, dueDate.toJulianDay());
     }
 
+    logActivity(patronId, Activity::Borrowed, itemId);
+    notifyItemChanged(ItemChange::Updated, itemId);
 
-    QSqlQuery query6;
-
-    query6.prepare("UPDATE items SET status_ = 'CheckedOut' WHERE itemid_ = :itemId");
-    query6.bindValue(":itemId", itemId);
-    if (!query6.exec()) return false;
-
-    QSqlQuery query7;
-
-    query7.prepare("INSERT INTO loans (userid_, itemid_, checkoutDate_, dueDate_) "
-                   "VALUES (:patronId, :itemId, :checkoutDate_, :dueDate_)");
-    QString checkoutDate = QDate::currentDate().toString("yyyy-MM-dd");
-    QString dueDate =  QDate::currentDate().addDays(LOAN_PERIOD_DAYS).toString("yyyy-MM-dd");
-    query7.bindValue(":checkoutDate_", checkoutDate);
-    query7.bindValue(":dueDate_", dueDate);
-    query7.bindValue(":patronId", patronId);
-    query7.bindValue(":itemId", itemId);
-    if (!query7.exec()) return false;
-
-
-//    for (auto& i : items_) {
-//        if (i->id() == itemId) {
-//            i->setStatus(ItemStatus::CheckedOut);
-//            break;
-//        }
-//    }
-
-    Loan loan{ itemId, patronId, QDate::currentDate(), QDate::currentDate().addDays(LOAN_PERIOD_DAYS) };
-    loansByItemId_[itemId] = loan;
-
-    getItemsFromDB();
     return true;
 
 }
 
 bool LibrarySystem::returnItem(int patronId, int itemId) {
+    {
+        std::shared_lock lock(cacheMutex_);
+        auto loan = loansByItemId_.find(itemId);
+        if (loan == loansByItemId_.end() || loan->second.patronId != patronId) return false;
+    }
 
+    QSqlDatabase db = pool_.connection();
 
-    QSqlQuery query1;
+    // The loan row and the item status change together, so the loan counters stay exact.
+    if (!db.transaction()) {
+        qDebug() << "ERROR:" << db.lastError().text();
+        return false;
+    }
 
-    query1.prepare("SELECT * FROM loans WHERE itemid_ = :itemId AND userid_ = :patronId");
+    QSqlQuery query1(db);
+    query1.prepare("DELETE FROM loans WHERE itemid_ = :itemId AND userid_ = :patronId");
     query1.bindValue(":itemId", itemId);
     query1.bindValue(":patronId", patronId);
-    if (!query1.exec() || !query1.next()) {
+    if (!query1.exec() || query1.numRowsAffected() < 1) {
         qDebug() << "Error:" << query1.lastError().text();
+        db.rollback();
         return false;
     }
 
-    QSqlQuery query2;
-    query2.prepare("DELETE FROM loans WHERE itemid_ = :itemId AND userid_ = :patronId");
+    QSqlQuery query2(db);
+    query2.prepare("UPDATE items SET status_ = :status_ WHERE itemid_ = :itemId");
+    query2.bindValue(":status_", "Available");
     query2.bindValue(":itemId", itemId);
-    query2.bindValue(":patronId", patronId);
     if (!query2.exec()) {
         qDebug() << "Error:" << query2.lastError().text();
+        db.rollback();
         return false;
     }
 
-    QSqlQuery query3;
-    query3.prepare("UPDATE items SET status_ = :status_ WHERE itemid_ = :itemId");
-    query3.bindValue(":status_", "Available");
-    query3.bindValue(":itemId", itemId);
-    if (!query3.exec()) {
-        qDebug() << "Error:" << query3.lastError().text();
+    if (!db.commit()) {
+        qDebug() << "ERROR:" << db.lastError().text();
+        db.rollback();
         return false;
     }
 
-    auto it = loansByItemId_.find(itemId);
-    if (it != loansByItemId_.end()) {
-        loansByItemId_.erase(it);
+    {
+        std::unique_lock lock(cacheMutex_);
+        items_.setStatus(itemId, ItemStatus::Available);
+        auto loan = loansByItemId_.find(itemId);
+        if (loan != loansByItemId_.end()) {
+            forgetOverdue(loan->second);
+            loansByItemId_.erase(loan);
+        }
+        dueDates_.cancel(itemId);
+        releaseLoanSlot(patronId);
     }
 
-//    for (auto& itemPtr : items_) {
-//        if (itemPtr->id() == itemId) {
-//            itemPtr->setStatus(ItemStatus::Available);
-//            qDebug() << "Retturning ITEM";
-//            break;
-//        }
-//    }
-
-    getItemsFromDB();
+    logActivity(patronId, Activity::Returned, itemId);
+    notifyItemChanged(ItemChange::Updated, itemId);
 
     return true;
 
@@ -300,99 +556,74 @@ bool LibrarySystem::returnItem(int patronId, int itemId) {
 }
 
 bool LibrarySystem::placeHold(int patronId, int itemId) {
+    if (!getPatronById(patronId)) return false;   // Must be a Patron
 
-        QSqlQuery query1;
-        query1.prepare("SELECT userid_, role_ FROM users WHERE userid_ = :patronId");
-        query1.bindValue(":patronId", patronId);
-        if (!query1.exec() || !query1.next()) {
-            return false; // User not found
-        }
-
-        std::string role_ = query1.value("role_").toString().toStdString();
-
-        if(role_ != "Patron"){
-            return false; // Must be a Patron
-        }
-
-        QSqlQuery query2;
-
-        query2.prepare("SELECT status_ FROM items WHERE itemid_ = :itemId");
-        query2.bindValue(":itemId", itemId);
-        if (!query2.exec() || !query2.next()) {
-            return false; // Item not found
-        }
-
-        std::string status_ = query2.value("status_").toString().toStdString();
-
-        // Check if the item is Available with no holds
-        if ( status_ == "Available") {
-            QSqlQuery checkHolds;
-            checkHolds.prepare("SELECT holdid_ FROM holds WHERE itemid_ = :itemId");
-            checkHolds.bindValue(":itemId", itemId);
-            if (!checkHolds.exec()) return false;
-
-            // If item is Available AND no holds exist, the item is free to borrow. Cannot place a hold.
-            if (!checkHolds.next()) {
-                return false;
-            }
-        }
+    // Held from the duplicate check until holds_ has the new id, so holds reach the
+    // cache in holdid_ order and one patron can't queue twice for the same item.
+    std::lock_guard placing(placeHoldMutex_);
+    {
+        std::shared_lock lock(cacheMutex_);
+        const auto slot = items_.slotOf(itemId);
+        if (!slot) return false;   // Item not found
 
-        // If status is CheckedOut OR status is Available with holds, continue to place the new hold.
+        // An Available item with no holds is free to borrow, so there is nothing to wait for.
+        if (items_.statuses()[*slot] == ItemStatus::Available && !holds_.hasHolds(itemId)) return false;
 
-        QSqlQuery query3;
-        // Check if patron already has the item on loan
-        query3.prepare("SELECT userid_, itemid_ FROM loans WHERE itemid_ = :itemId AND userid_ = :patronId");
-        query3.bindValue(":itemId", itemId);
-        query3.bindValue(":patronId", patronId);
-        if (query3.exec() && query3.next()) {
-            return false;
-        }
+        // Already waiting for this item
+        if (holds_.contains(itemId, patronId)) return false;
+    }
 
+    QSqlDatabase db = pool_.connection();
 
-        QSqlQuery query4;
-        // Check if patron already has an active hold on this item
-        query4.prepare("SELECT userid_, itemid_ FROM holds WHERE itemid_ = :itemId AND userid_ = :patronId");
-        query4.bindValue(":itemId", itemId);
-        query4.bindValue(":patronId", patronId);
-        if (query4.exec() && query4.next()) {
-            return false;
-        }
+    QSqlQuery query2(db);
+    // Insert the new hold unless the patron already has the item on loan. One statement, so
+    // a borrow by the same patron cannot commit between the check and the insert.
+    query2.prepare("INSERT INTO holds (itemid_, userid_) SELECT :itemId, :patronId "
+                   "WHERE NOT EXISTS (SELECT 1 FROM loans WHERE itemid_ = :loanItemId AND userid_ = :loanPatronId)");
+    query2.bindValue(":itemId", itemId);
+    query2.bindValue(":patronId", patronId);
+    query2.bindValue(":loanItemId", itemId);
+    query2.bindValue(":loanPatronId", patronId);
 
-        QSqlQuery query5;
-        // Insert the new hold
-        query5.prepare("INSERT INTO holds (itemid_, userid_) VALUES (:itemId, :patronId)");
-        query5.bindValue(":itemId", itemId);
-        query5.bindValue(":patronId", patronId);
+    if (!query2.exec()) {
+         qDebug() << "Error:" << query2.lastError().text();
+         return false;
+    }
+    if (query2.numRowsAffected() < 1) return false;   // already on loan to this patron
 
-        if (!query5.exec()) {
-             qDebug() << "Error:" << query5.lastError().text();
-             return false;
+    {
+        std::unique_lock lock(cacheMutex_);
+        if (!holds_.add(itemId, patronId, query2.lastInsertId().toInt())) {
+            qDebug() << "ERROR: hold" << query2.lastInsertId() << "on item" << itemId << "is out of order in the hold cache";
         }
-
-        return true;
+    }
+    logActivity(patronId, Activity::PlacedHold, itemId);
+    return true;
 
 }
 
 
 bool LibrarySystem::cancelHold(int patronId, int itemId) {
-    QSqlQuery query1;
-    query1.prepare("SELECT itemid_, userid_ FROM holds WHERE userid_ = :patronId  AND itemid_ = :itemId");
+    {
+        std::shared_lock lock(cacheMutex_);
+        if (!holds_.contains(itemId, patronId)) return false;
+    }
+
+    QSqlDatabase db = pool_.connection();
+    QSqlQuery query1(db);
+    query1.prepare("DELETE FROM holds WHERE userid_ = :patronId AND itemid_ = :itemId");
     query1.bindValue(":patronId", patronId);
     query1.bindValue(":itemId", itemId);
 
-    if(!query1.exec() || !query1.next()){
+    if(!query1.exec()){
         return false;
     }
 
-    QSqlQuery query2;
-    query2.prepare("DELETE FROM holds WHERE userid_ = :patronId AND itemid_ = :itemId");
-    query2.bindValue(":patronId", patronId);
-    query2.bindValue(":itemId", itemId);
-
-    if(!query2.exec()){
-        return false;
+    {
+        std::unique_lock lock(cacheMutex_);
+        holds_.remove(itemId, patronId);
     }
-
+    logActivity(patronId, Activity::CancelledHold, itemId);
     return true;
 
 
@@ -400,8 +631,9 @@ bool LibrarySystem::cancelHold(int patronId, int itemId) {
 
 std::vector<LibrarySystem::AccountLoan>
 LibrarySystem::getAccountLoans(int patronId, const QDate& today) const {
+    QSqlDatabase db = pool_.connection(ConnectionPool::Access::ReadOnly);
     std::vector<AccountLoan> out;
-    QSqlQuery query1;
+    QSqlQuery query1(db);
     query1.prepare("SELECT l.dueDate_, i.itemid_, i.title_ FROM loans l JOIN items i ON i.itemid_ = l.itemid_ WHERE l.userid_ = :patronId");
     query1.bindValue(":patronId", patronId);
     if (!query1.exec()) {
@@ -409,99 +641,178 @@ LibrarySystem::getAccountLoans(int patronId, const QDate& today) const {
         return out;
     }
 
-      while (query1.next()) {
-          AccountLoan al;
-          al.itemId = query1.value("itemid_").toInt();
-          al.title = query1.value("title_").toString().toStdString();
-          QDate dueDate = query1.value("dueDate_").toDate();
-          al.dueDate = dueDate;
-          al.daysRemaining = today.daysTo(dueDate);
+    while (query1.next()) {
+        AccountLoan al;
+        al.itemId = query1.value("itemid_").toInt();
+        al.title = query1.value("title_").toString().toStdString();
+        QDate dueDate = query1.value("dueDate_").toDate();
+        al.dueDate = dueDate;
+        al.daysRemaining = today.daysTo(dueDate);
 
-          out.push_back(std::move(al));
-      }
+        al.standing = LoanStanding::Current;
+
+        out.push_back(std::move(al));
+    }
+
+    std::shared_lock lock(cacheMutex_);
+    for (AccountLoan& al : out) {
+        auto loan = loansByItemId_.find(al.itemId);
+        if (loan != loansByItemId_.end()) al.standing = loan->second.standing;
+    }
 
-      return out;
+    return out;
 }
 
 std::vector<LibrarySystem::AccountHold>
 LibrarySystem::getAccountHolds(int patronId) const {
     std::vector<AccountHold> out;
 
-
-    QSqlQuery query1;
-    query1.prepare("SELECT itemid_ FROM holds WHERE userid_= :patronId");
-    query1.bindValue(":patronId", patronId);
-
-    if (!query1.exec()) {
-        qDebug() << "ERROR:" << query1.lastError().text();
-        return out;
+    // Queue positions and titles both come from memory.
+    std::shared_lock lock(cacheMutex_);
+    for (const auto& hold : holds_.holdsOf(patronId)) {
+        const auto slot = items_.slotOf(hold.itemId);
+        if (!slot) continue;
+        AccountHold foundItemQueuePos;
+        foundItemQueuePos.itemId = hold.itemId;
+        foundItemQueuePos.title = std::string(items_.title(*slot));
+        foundItemQueuePos.queuePosition = hold.queuePosition;
+        out.push_back(std::move(foundItemQueuePos));
     }
 
-    while (query1.next()) {
+    return out;
+}
+std::vector<LibrarySystem::LoanEvent> LibrarySystem::runDueDateCheck(const QDate& today) {
+    std::unique_lock lock(cacheMutex_);
+    return applyDueDateEvents(dueDates_.advanceTo(today.toJulianDay()));
+}
 
-        int itemid_ = query1.value("itemid_").toInt();
+std::vector<LibrarySystem::OverdueLoan> LibrarySystem::getOverdueLoans(int patronId, const QDate& today) const {
+    std::vector<OverdueLoan> out;
+    std::shared_lock lock(cacheMutex_);
+    auto patron = overdueItemsByPatron_.find(patronId);
+    if (patron != overdueItemsByPatron_.end()) appendOverdueLoans(patronId, patron->second, today, out);
+    return out;
+}
 
-        QSqlQuery query2;
-        query2.prepare("SELECT userid_ FROM holds WHERE itemid_= :itemid_ ORDER BY holdid_ ASC");
-        query2.bindValue(":itemid_", itemid_);
+std::vector<LibrarySystem::OverdueLoan> LibrarySystem::getAllOverdueLoans(const QDate& today) const {
+    std::vector<OverdueLoan> out;
+    std::shared_lock lock(cacheMutex_);
+    for (const auto& [patronId, itemIds] : overdueItemsByPatron_) {
+        appendOverdueLoans(patronId, itemIds, today, out);
+    }
+    return out;
+}
 
-        if (!query2.exec()) {
-            qDebug() << "ERROR:" << query1.lastError().text();
-            continue;
-        }
+ActivityLogStats LibrarySystem::activityLogStats() const {
+    return activityLog_ ? activityLog_->stats() : ActivityLogStats{ 0, 0, 0 };
+}
 
-        int queuePos = 1;
-        while(query2.next()){
-            if(query2.value("userid_").toInt() == patronId){
-                QSqlQuery query3;
-                query3.prepare("SELECT itemid_, title_ FROM items WHERE itemid_ = :itemid_");
-                query3.bindValue(":itemid_", itemid_);
-                if (!query3.exec()) {
-                    qDebug() << "ERROR:" << query3.lastError().text();
-                    continue;
-                }
+bool LibrarySystem::flushActivityLog() {
+    return !activityLog_ || activityLog_->flush();
+}
 
-                if(query3.next()){
-                    AccountHold foundItemQueuePos;
-                    foundItemQueuePos.itemId = query3.value("itemid_").toUInt();
-                    foundItemQueuePos.title = query3.value("title_").toString().toStdString();
-                    foundItemQueuePos.queuePosition = queuePos;
-                    out.push_back(std::move(foundItemQueuePos));
-                }
+// --- helpers ---
 
+// Queues the useractivity row; the logger's writer thread inserts it with others later.
+void LibrarySystem::logActivity(int userId, Activity activity, int itemId) {
+    if (activityLog_) activityLog_->log(userId, activity, itemId);
+}
 
+// Reads one patron id range of overdue loans on the calling thread's read connection.
+std::optional<FineTally> LibrarySystem::scanOverdueLoans(int firstPatronId, int lastPatronId, const QDate& assessedOn,
+                                                         const FinePolicy& policy) const {
+    QSqlDatabase db = pool_.connection(ConnectionPool::Access::ReadOnly);
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    // idx_loans_user_item (userid_, itemid_, dueDate_) plus the rowid covers this query in patron order.
+    query.prepare("SELECT loanid_, userid_, itemid_, dueDate_ FROM loans "
+                  "WHERE userid_ BETWEEN :first AND :last AND dueDate_ < :today ORDER BY userid_");
+    query.bindValue(":first", firstPatronId);
+    query.bindValue(":last", lastPatronId);
+    query.bindValue(":today", assessedOn.toString("yyyy-MM-dd"));
+    if (!query.exec()) {
+        qDebug() << "ERROR:" << query.lastError().text();
+        return std::nullopt;
+    }
 
-                break;
-            }
-            queuePos++;
+    FineTally tally(assessedOn.toJulianDay(), policy);
+    while (query.next()) {
+        if (!tally.add(query.value(0).toLongLong(), query.value(1).toInt(), query.value(2).toInt(),
+                       query.value(3).toString())) {
+            qDebug() << "ERROR: loan" << query.value(0).toLongLong() << "has an unreadable due date";
         }
-
     }
+    return tally;
+}
 
-    return out;
+// Caller holds cacheMutex_ exclusively. Standings only move forward, so a late or
+// repeated event cannot turn an Overdue loan back into DueSoon.
+std::vector<LibrarySystem::LoanEvent>
+LibrarySystem::applyDueDateEvents(const std::vector<DueDateScheduler::Fired>& fired) {
+    std::vector<LoanEvent> events;
+    events.reserve(fired.size());
+    for (const auto& timer : fired) {
+        auto found = loansByItemId_.find(timer.itemId);
+        if (found == loansByItemId_.end()) continue;
+        Loan& loan = found->second;
+        const LoanStanding standing = timer.event == DueDateScheduler::Event::Overdue ? LoanStanding::Overdue
+                                                                                      : LoanStanding::DueSoon;
+        if (standing <= loan.standing) continue;
+        loan.standing = standing;
+        if (standing == LoanStanding::Overdue) overdueItemsByPatron_[loan.patronId].push_back(loan.itemId);
+        events.push_back({ standing, loan.itemId, loan.patronId, loan.due });
+    }
+    return events;
 }
-// --- helpers ---
 
-int LibrarySystem::countLoansForPatron(int patronId) const {
-    QSqlQuery query1;
-    query1.prepare("SELECT COUNT(*) AS num_of_loans FROM loans WHERE userid_= :patronId");
-    query1.bindValue(":patronId", patronId);
+// Caller holds cacheMutex_ exclusively.
+void LibrarySystem::forgetOverdue(const Loan& loan) {
+    if (loan.standing != LoanStanding::Overdue) return;
+    auto patron = overdueItemsByPatron_.find(loan.patronId);
+    if (patron == overdueItemsByPatron_.end()) return;
+    auto& itemIds = patron->second;
+    itemIds.erase(std::remove(itemIds.begin(), itemIds.end(), loan.itemId), itemIds.end());
+    if (itemIds.empty()) overdueItemsByPatron_.erase(patron);
+}
 
-    if (!query1.exec()) {
-        qDebug() << "ERROR:" << query1.lastError().text();
-        return 0;
+// Caller holds cacheMutex_.
+void LibrarySystem::appendOverdueLoans(int patronId, const std::vector<int>& itemIds, const QDate& today,
+                                       std::vector<OverdueLoan>& out) const {
+    const std::size_t first = out.size();
+    for (int itemId : itemIds) {
+        auto loan = loansByItemId_.find(itemId);
+        if (loan == loansByItemId_.end()) continue;
+        const auto slot = items_.slotOf(itemId);
+        OverdueLoan overdue;
+        overdue.patronId = patronId;
+        overdue.itemId = itemId;
+        overdue.title = slot ? std::string(items_.title(*slot)) : std::string();
+        overdue.dueDate = loan->second.due;
+        overdue.daysOverdue = loan->second.due.daysTo(today);
+        out.push_back(std::move(overdue));
     }
+    std::sort(out.begin() + static_cast<std::ptrdiff_t>(first), out.end(),
+              [](const OverdueLoan& a, const OverdueLoan& b) { return a.dueDate < b.dueDate; });
+}
 
-    if(!query1.next()){
-        return 0;
-    }
 
-    return query1.value("num_of_loans").toInt();
+// activeLoansByPatron_ is kept by getLoansFromDB, borrowItem and returnItem, so the limit
+// check never queries loans. Both helpers expect cacheMutex_ to be held exclusively.
+bool LibrarySystem::reserveLoanSlot(int patronId) {
+    auto it = activeLoansByPatron_.find(patronId);
+    if (it != activeLoansByPatron_.end() && it->second >= MAX_ACTIVE_LOANS) return false;
+    ++activeLoansByPatron_[patronId];
+    return true;
+}
 
+void LibrarySystem::releaseLoanSlot(int patronId) {
+    auto it = activeLoansByPatron_.find(patronId);
+    if (it != activeLoansByPatron_.end() && --it->second <= 0) activeLoansByPatron_.erase(it);
 }
 
 bool LibrarySystem::isLoanedBy(int itemId, int patronId) const {
-    QSqlQuery query1;
+    QSqlDatabase db = pool_.connection(ConnectionPool::Access::ReadOnly);
+    QSqlQuery query1(db);
     query1.prepare("SELECT userid_ FROM loans WHERE itemid_ = :itemId AND userid_ = :patronId");
     query1.bindValue(":itemId", itemId);
     query1.bindValue(":patronId", patronId);
@@ -530,202 +841,290 @@ bool LibrarySystem::removeItemFromCatalogue(int librarianId, int itemId){
     if (it == usersById_.end()) return false;
     if (it->second->role() != Role::Librarian) return false;
 
-    QSqlQuery query1;
-    query1.prepare(
-        "SELECT * FROM  items WHERE itemid_ = :itemid_"
-    );
-
-    query1.bindValue(":itemid_", itemId);
-    if (!query1.exec() || !query1.next()) return false;
-
-    std::string status_ = query1.value("status_").toString().toStdString();
-
-    if(status_ != "Available") return false;
+    QSqlDatabase db = pool_.connection();
+    // One transaction: the first DELETE takes the write lock, so no borrow can commit
+    // between the status check and the removal of the item.
+    if (!db.transaction()) {
+        qDebug() << "ERROR:" << db.lastError().text();
+        return false;
+    }
 
-    QSqlQuery query2;
+    QSqlQuery query2(db);
     query2.prepare("DELETE FROM holds WHERE itemid_ = :itemid_");
     query2.bindValue(":itemid_", itemId);
 
-    if (!query2.exec()) return false;
+    if (!query2.exec()) {
+        qDebug() << "ERROR:" << query2.lastError().text();
+        db.rollback();
+        return false;
+    }
 
-    QSqlQuery query3;
-    query3.prepare("DELETE FROM items WHERE itemid_ = :itemid_");
+    QSqlQuery query3(db);
+    query3.prepare("DELETE FROM items WHERE itemid_ = :itemid_ AND status_ = 'Available' "
+                   "AND NOT EXISTS (SELECT 1 FROM loans WHERE itemid_ = :loanItemId)");
     query3.bindValue(":itemid_", itemId);
+    query3.bindValue(":loanItemId", itemId);
 
-    if (!query3.exec()) return false;
-
-
+    if (!query3.exec()) {
+        qDebug() << "ERROR:" << query3.lastError().text();
+        db.rollback();
+        return false;
+    }
+    if (query3.numRowsAffected() < 1) {     // no such item, or it is checked out
+        db.rollback();
+        return false;
+    }
+    if (!db.commit()) {
+        qDebug() << "ERROR:" << db.lastError().text();
+        db.rollback();
+        return false;
+    }
 
-    getItemsFromDB();
+    bool removed = false;
+    ItemView view;      // keeps the title and creator readable after the row leaves items_
+    {
+        std::unique_lock lock(cacheMutex_);
+        holds_.removeItem(itemId);
+        view = items_.find(itemId);
+        removed = items_.remove(itemId);
+    }
+    if (removed) {
+        textIndex_.remove(itemId, view.title(), view.creator());
+        notifyItemChanged(ItemChange::Removed, itemId);
+    }
     return true;
 
 
 }
 
-//void LibrarySystem::removeItemByID(int itemid_){
-
-//    auto itemStart = std::remove_if(
-//        items_.begin(),
-//        items_.end(),
-//        [itemid_]( std::shared_ptr<Item>& p) {
-//            return (p != nullptr && p->id() == itemid_);
-//        }
-//    );
-
-//    items_.erase(itemStart, items_.end());
-//}
-
 bool LibrarySystem::addItemToCatalogue(int librarianID, const ItemInDB& item){
+    QSqlDatabase db = pool_.connection();
 
     auto it = usersById_.find(librarianID);
     if (it == usersById_.end()) return false;
     if (it->second->role() != Role::Librarian) return false;
 
-    QSqlQuery query1;
-
-    query1.prepare(
-        "INSERT INTO items (kind_, title_, creator_, publicationYear_, dewey_, isbn_, "
-        "issueNumber_, publicationDate_, genre_, rating_, status_) "
-        "VALUES (:kind_, :title_, :creator_, :publicationYear_, :dewey_, :isbn_, "
-        ":issueNumber_, :publicationDate_, :genre_, :rating_, :status_)"
-    );
-
-    query1.bindValue(":kind_", QString::fromStdString(item.kind_));
-    query1.bindValue(":title_", QString::fromStdString(item.title_));
-    query1.bindValue(":creator_", QString::fromStdString(item.creator_));
-    query1.bindValue(":publicationYear_", item.publicationYear_);
-
-    QVariant deweyVal_= item.dewey_.has_value() ? QVariant(QString::fromStdString(item.dewey_.value())) : QVariant(QVariant::String);
-
-    query1.bindValue(":dewey_", deweyVal_);
-
-    QVariant isbnVal_= item.isbn_.has_value() ? QVariant(QString::fromStdString(item.isbn_.value())) : QVariant(QVariant::String);
-
-    query1.bindValue(":isbn_", isbnVal_);
-
-    QVariant issueNumberVal_ = item.issueNumber_.has_value()  ? QVariant(item.issueNumber_.value()) : QVariant(QVariant::Int);
-
-    query1.bindValue(":issueNumber_", issueNumberVal_);
+    QSqlQuery query1(db);
 
-    QVariant publicationDateVal_ = item.publicationDate_.has_value() ? QVariant(item.publicationDate_.value().toString("yyyy-MM-dd")) : QVariant(QVariant::String);
+    query1.prepare(INSERT_ITEM_SQL);
 
-    query1.bindValue(":publicationDate_", publicationDateVal_);
-
-    QVariant genreVal_ = item.genre_.has_value() ? QVariant(QString::fromStdString(item.genre_.value())) : QVariant(QVariant::String);
-
-    query1.bindValue(":genre_", genreVal_);
-
-    QVariant ratingVal_ = item.rating_.has_value()? QVariant(QString::fromStdString(item.rating_.value())) : QVariant(QVariant::String);
-
-    query1.bindValue(":rating_", ratingVal_);
-
-    QString statusVal_ = "Available";
-
-    query1.bindValue(":status_", statusVal_);
+    bindItemValues(query1, item, ItemStatus::Available);
 
     if (!query1.exec()) {
         qDebug() << "ERROR: " << query1.lastError();
         return false;
     }
 
-// Commented out section uses updates in memory data
-//    int lastInsertedID = query1.lastInsertId().toInt();
-//    if (lastInsertedID < 1) {
-//        qDebug() << "ERROR: Somthing unexpected happened while inserting.";
-//        return false;
-//    }
-
-
-//    QSqlQuery query2;
-//    query2.prepare("SELECT * FROM items WHERE itemid_ = :itemid_");
-//    query2.bindValue(":itemid_", lastInsertedID);
-
-//    if (!query2.exec() || !query2.next()) return false;
-
-//    int itemid_ = query2.value("itemid_").toInt();
-//    std::string kind_ = query2.value("kind_").toString().toStdString();
-//    std::string title_ = query2.value("title_").toString().toStdString();
-//    std::string creator_ = query2.value("creator_").toString().toStdString();
-//    int publicationYear_ = query2.value("publicationYear_").toInt();
+    int lastInsertedID = query1.lastInsertId().toInt();
+    if (lastInsertedID < 1) {
+        qDebug() << "ERROR: Something unexpected happened while inserting.";
+        return false;
+    }
 
-//    std::optional<std::string> dewey_ = std::nullopt;
-//    QVariant deweyVal = query2.value("dewey_");
-//    if (!deweyVal.isNull()) {
-//        dewey_ = deweyVal.toString().toStdString();
-//    }
+    // Mirror the committed row in memory instead of reloading the whole catalogue.
+    ItemInDB inserted = item;
+    inserted.status_ = ItemStatus::Available;
+    bool appended = false;
+    {
+        std::unique_lock lock(cacheMutex_);
+        appended = items_.append(lastInsertedID, inserted);
+    }
+    if (appended) {
+        textIndex_.add(lastInsertedID, inserted.title_, inserted.creator_);
+        notifyItemChanged(ItemChange::Added, lastInsertedID);
+    }
 
-//    std::optional<std::string> isbn_ = std::nullopt;
-//    QVariant isbnVal = query2.value("isbn_");
-//    if (!isbnVal.isNull()) {
-//        isbn_ = isbnVal.toString().toStdString();
-//    }
+    return true;
 
-//    int issueNumber_ = -1;
-//    QVariant issueNumberVal = query2.value("issueNumber_");
-//    if (!issueNumberVal.isNull()) {
-//        issueNumber_ = issueNumberVal.toInt();
-//    }
+}
 
-//    QDate publicationDate_;
-//    QVariant publicationDateVal = query2.value("publicationDate_");
-//    if (!publicationDateVal.isNull()) {
-//        QString pubString_ = publicationDateVal.toString();
-//        publicationDate_ = QDate::fromString(pubString_, "yyyy-MM-dd");
-//    }
+ImportReport LibrarySystem::importCatalogue(int librarianID, QIODevice& source, ImportFormat format, int chunkSize) {
+    ImportReport report;
 
-//    std::string genre_ = "";
-//    QVariant genreVal = query2.value("genre_");
-//    if (!genreVal.isNull()) {
-//        genre_ = genreVal.toString().toStdString();
-//    }
+    auto it = usersById_.find(librarianID);
+    if (it == usersById_.end() || it->second->role() != Role::Librarian) return report;
 
-//    std::string rating_ = "";
-//    QVariant ratingVal = query2.value("rating_");
-//    if (!ratingVal.isNull()) {
-//        rating_ = ratingVal.toString().toStdString();
-//    }
+    QSqlDatabase db = pool_.connection();
+    QSqlQuery insert(db);
+    if (!insert.prepare(INSERT_ITEM_SQL)) {
+        qDebug() << "ERROR: " << insert.lastError();
+        return report;
+    }
 
-//    std::string status_ = query2.value("status_").toString().toStdString();
-//    ItemStatus itemStatus;
-//    if (status_ == "CheckedOut") {
-//        itemStatus = ItemStatus::CheckedOut;
-//    } else {
-//        itemStatus = ItemStatus::Available;
-//    }
+    CatalogueRecordReader reader(source, format);
+    ImportRecord record;
+    std::vector<std::pair<int, ItemInDB>> added;
+    bool more = true;
+    bool failed = false;
+
+    // One transaction per chunk of inserted rows; rejected rows don't count towards a chunk.
+    while (more && !failed) {
+        if (!db.transaction()) {
+            qDebug() << "ERROR:" << db.lastError().text();
+            failed = true;
+            break;
+        }
 
-//    if (kind_ == "FictionBook") {
+        std::vector<std::pair<int, ItemInDB>> chunk;
+        while (static_cast<int>(chunk.size()) < std::max(1, chunkSize) && (more = reader.next(record))) {
+            if (!record.error.empty()) {
+                report.rejected.push_back({ record.line, record.error });
+                continue;
+            }
+            bindItemValues(insert, record.item, record.item.status_);
+            if (!insert.exec()) {
+                report.rejected.push_back({ record.line, insert.lastError().text().toStdString() });
+                continue;
+            }
+            chunk.emplace_back(insert.lastInsertId().toInt(), std::move(record.item));
+        }
 
-//        items_.push_back(std::make_shared<Book>(itemid_, title_, creator_, publicationYear_,BookType::Fiction, dewey_, isbn_, itemStatus));
+        if (!db.commit()) {
+            qDebug() << "ERROR:" << db.lastError().text();
+            db.rollback();
+            failed = true;
+            break;
+        }
+        std::move(chunk.begin(), chunk.end(), std::back_inserter(added));
+    }
 
-//    } else if (kind_ == "NonFictionBook") {
+    // Publish everything that was committed in one step, instead of once per row.
+    if (!added.empty()) {
+        {
+            std::unique_lock lock(cacheMutex_);
+            items_.reserve(items_.size() + added.size());
+            for (const auto& [itemId, row] : added) items_.append(itemId, row);
+        }
+        for (const auto& [itemId, row] : added) textIndex_.add(itemId, row.title_, row.creator_);
+        notifyItemChanged(ItemChange::Reloaded, 0);
+    }
 
-//        items_.push_back(std::make_shared<Book>(itemid_, title_, creator_, publicationYear_, BookType::NonFiction, dewey_, isbn_, itemStatus));
+    report.imported = static_cast<int>(added.size());
+    report.completed = !failed;
+    return report;
+}
 
-//    } else if (kind_ == "Magazine") {
 
-//        items_.push_back(std::make_shared<Magazine>(itemid_, title_, creator_, publicationYear_, issueNumber_, publicationDate_, itemStatus));
+qint64 LibrarySystem::exportRecords(const ExportOptions& options, QIODevice& sink) const {
+    const ExportQuery plan = buildExportQuery(options);
+    if (!plan.error.empty()) {
+        qDebug() << "ERROR:" << QString::fromStdString(plan.error);
+        return -1;
+    }
 
-//    } else if (kind_ == "Movie") {
+    QSqlDatabase db = pool_.connection(ConnectionPool::Access::ReadOnly);
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare(plan.sql);
+    for (const auto& [name, value] : plan.bindings) query.bindValue(name, value);
+    if (!query.exec()) {
+        qDebug() << "ERROR:" << query.lastError().text();
+        return -1;
+    }
 
-//        items_.push_back(std::make_shared<Movie>(itemid_, title_, creator_, publicationYear_, genre_, rating_, itemStatus));
+    RecordWriter writer(sink, options.format, plan.columns);
+    if (!writer.writeHeader()) return -1;
 
-//    } else if (kind_ == "VideoGame") {
+    std::vector<QVariant> values(plan.columns.size());
+    qint64 rows = 0;
+    while (query.next()) {
+        for (int c = 0; c < plan.columns.size(); ++c) values[c] = query.value(c);
+        if (!writer.writeRow(values)) {
+            qDebug() << "ERROR: export write failed after" << rows << "rows";
+            return -1;
+        }
+        ++rows;
+    }
+    return rows;
+}
 
-//        items_.push_back(std::make_shared<VideoGame>(itemid_, title_, creator_, publicationYear_, genre_, rating_, itemStatus));
-//    }
+FineReport LibrarySystem::assessFines(const QDate& assessedOn, int threads, const FinePolicy& policy) {
+    FineReport report;
+    report.assessedOn = assessedOn;
+    QSqlDatabase db = pool_.connection();
 
-    // here we are cleearing the items in mmemoy data and refetching directly  from the database  so the data reeflects the most up to  date changes,  modificatiion and addiitions
-    getItemsFromDB();
+    // Two scalar subqueries, so each bound is one index seek; MIN and MAX together scan the index.
+    QSqlQuery bounds(db);
+    if (!bounds.exec("SELECT (SELECT MIN(userid_) FROM loans), (SELECT MAX(userid_) FROM loans)") || !bounds.next()) {
+        qDebug() << "ERROR:" << bounds.lastError().text();
+        return report;
+    }
+    if (bounds.value(0).isNull()) {
+        report.completed = true;     // no loans, nothing to fine
+        return report;
+    }
+    const qint64 firstPatron = bounds.value(0).toLongLong();
+    const qint64 lastPatron = bounds.value(1).toLongLong();
+
+    // Consecutive patron id ranges, so the tallies concatenate back into patron order.
+    const qint64 parts = std::clamp<qint64>(threads, 1, std::min<qint64>(MAX_FINE_THREADS, lastPatron - firstPatron + 1));
+    const qint64 span = (lastPatron - firstPatron) / parts + 1;
+    std::optional<FineTally> total;
+    if (parts == 1) {
+        total = scanOverdueLoans(static_cast<int>(firstPatron), static_cast<int>(lastPatron), assessedOn, policy);
+    } else {
+        std::vector<QFuture<std::optional<FineTally>>> scans;
+        for (qint64 from = firstPatron; from <= lastPatron; from += span) {
+            const int first = static_cast<int>(from);
+            const int last = static_cast<int>(std::min(lastPatron, from + span - 1));
+            scans.push_back(QtConcurrent::run(&fineScanThreads_, [this, first, last, assessedOn, policy]() {
+                return scanOverdueLoans(first, last, assessedOn, policy);
+            }));
+        }
+        bool failed = false;
+        for (auto& scan : scans) {
+            std::optional<FineTally> part = scan.result();     // wait for every range, even after a failure
+            if (!part) {
+                failed = true;
+            } else if (!total) {
+                total = std::move(part);
+            } else {
+                total->append(std::move(*part));
+            }
+        }
+        if (failed) total.reset();
+    }
+    if (!total) return report;
 
-    return true;
+    if (!db.transaction()) {
+        qDebug() << "ERROR:" << db.lastError().text();
+        return report;
+    }
+    QSqlQuery insert(db);
+    insert.prepare("INSERT OR REPLACE INTO fines (loanid_, userid_, itemid_, daysOverdue_, amountCents_, assessedOn_) "
+                   "VALUES (:loanid_, :userid_, :itemid_, :daysOverdue_, :amountCents_, :assessedOn_)");
+    insert.bindValue(":assessedOn_", assessedOn.toString("yyyy-MM-dd"));   // stays bound across exec()
+    for (const AssessedFine& fine : total->fines()) {
+        insert.bindValue(":loanid_", fine.loanId);
+        insert.bindValue(":userid_", fine.patronId);
+        insert.bindValue(":itemid_", fine.itemId);
+        insert.bindValue(":daysOverdue_", fine.daysOverdue);
+        insert.bindValue(":amountCents_", fine.cents);
+        if (!insert.exec()) {
+            qDebug() << "ERROR:" << insert.lastError().text();
+            db.rollback();
+            return report;
+        }
+    }
+    if (!db.commit()) {
+        qDebug() << "ERROR:" << db.lastError().text();
+        db.rollback();
+        return report;
+    }
 
+    report.overdueLoans = total->overdueLoans();
+    report.finesWritten = static_cast<qint64>(total->fines().size());
+    report.totalCents = total->totalCents();
+    report.byPatron = total->patrons();
+    report.completed = true;
+    return report;
 }
 
-
 std::shared_ptr<User> LibrarySystem::LibrarianFindPatronByName(const std::string& name) const {
+    QSqlDatabase db = pool_.connection(ConnectionPool::Access::ReadOnly);
 
 
-    QSqlQuery query1;
+    QSqlQuery query1(db);
 
     query1.prepare(
         "SELECT * FROM users WHERE LOWER(name_) LIKE '%' || LOWER(:name) || '%'"
@@ -3,9 +3,13 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
-#include <deque>
 #include <optional>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
 #include <QDate>
+#include <QThreadPool>
 
 #include "User.h"
 #include "Patron.h"
@@ -15,6 +19,16 @@
 #include "VideoGame.h"
 #include "Magazine.h"
 #include "itemInDB.h"
+#include "ItemStore.h"
+#include "HoldQueues.h"
+#include "DueDateScheduler.h"
+#include "ItemTextIndex.h"
+#include "ConnectionPool.h"
+#include "DatabaseProfile.h"
+#include "CatalogueImport.h"
+#include "CatalogueExport.h"
+#include "FineAssessment.h"
+#include "ActivityLog.h"
 
 #include <QSqlDatabase>
 #include <QSqlQuery>
@@ -24,21 +38,73 @@
 
 namespace hinlibs {
 
+// Threading: every public method except allItems() may be called from any thread.
+// SQL goes through ConnectionPool, so each thread uses its own connection; reads use
+// one of the bounded read-only connections when one is free.
 class LibrarySystem {
 public:
-    LibrarySystem();
+    // The profile's PRAGMAs are applied to every pooled connection; see DatabaseProfile
+    // for the HINLIBS_DB_PROFILE / HINLIBS_DB_CONFIG settings read by default.
+    // Borrows, returns and hold changes are recorded in useractivity through an
+    // ActivityLogger configured by activityLog.
+    explicit LibrarySystem(const QString& databasePath = DEFAULT_DATABASE_PATH,
+                           const DatabaseProfile& profile = DatabaseProfile::fromEnvironment(),
+                           const ActivityLogOptions& activityLog = ActivityLogOptions::fromEnvironment());
+
+    const DatabaseProfile& databaseProfile() const noexcept { return profile_; }
 
     // --- DB OPerations --
     void getUsersFromDB();
     void getItemsFromDB();
+    void getHoldsFromDB();
+    // Also checks the loans against item statuses and logs any disagreement.
+    void getLoansFromDB();
 
     // --- Users ---
     std::shared_ptr<User> findUserByName(const std::string& name) const;
     std::shared_ptr<Patron> getPatronById(int patronId) const;
 
     // --- Items ---
-    std::shared_ptr<Item> getItemById(int itemId) const;
-    const std::vector<std::shared_ptr<Item>>& allItems();
+    // Empty view if there is no such item.
+    ItemView getItemById(int itemId) const;
+    // Not synchronised: only use on the database thread.
+    const ItemStore& allItems() const;
+    // Keyset page of the catalogue in id order: up to limit items with id > afterItemId,
+    // optionally only those of one kind and/or status. With a rare filter this walks most
+    // of the catalogue, so call it off the GUI thread (AsyncLibrarySystem::itemsAfter).
+    std::vector<ItemView> itemsAfter(int afterItemId, std::size_t limit,
+                                     std::optional<CatalogueKind> kind = std::nullopt,
+                                     std::optional<ItemStatus> status = std::nullopt) const;
+
+    // --- Item change notification ---
+    // Listeners run after the change has been committed and applied to the cache,
+    // on the database thread. Reloaded means "everything may have changed" (itemId is 0).
+    // Once removeItemChangeListener returns, that listener will not be called again.
+    enum class ItemChange { Added, Updated, Removed, Reloaded };
+    using ItemChangeListener = std::function<void(ItemChange change, int itemId)>;
+    int addItemChangeListener(ItemChangeListener listener);
+    void removeItemChangeListener(int listenerId);
+
+    // --- Catalogue search ---
+    struct CatalogueSearch {
+        std::string text;                   // matched against title, creator, ISBN, genre and Dewey
+        std::optional<std::string> kind;    // items.kind_ value, e.g. "Movie"
+        std::optional<ItemStatus> status;
+        int limit = 50;
+        int offset = 0;
+    };
+    // BM25-ranked page of matching items; each word in text is treated as a prefix.
+    std::vector<ItemView> searchCatalogue(const CatalogueSearch& search) const;
+    // In-memory title/creator match for search-as-you-type. Safe to call from a worker
+    // thread; pass cancelled to abandon a search that a newer keystroke has superseded.
+    std::vector<int> suggestItemIds(const std::string& text, std::size_t limit,
+                                    const ItemTextIndex::CancelCheck& cancelled = {}) const;
+
+    // --- Facets (in memory; creators, genres and ratings compare as dictionary codes) ---
+    // Distinct values with their item counts, most common first.
+    std::vector<std::pair<std::string, std::size_t>> facetCounts(ItemFacet facet) const;
+    // Up to limit items, in id order, whose facet equals value exactly.
+    std::vector<ItemView> itemsWithFacet(ItemFacet facet, const std::string& value, std::size_t limit) const;
 
     // --- Patron operations ---
     bool borrowItem(int patronId, int itemId);                    
@@ -47,12 +113,15 @@ public:
     bool cancelHold(int patronId, int itemId);
     bool isLoanedBy(int itemId, int patronId) const;
 
+    // Set by the due-date check, not recomputed from the clock on every read.
+    enum class LoanStanding { Current, DueSoon, Overdue };
 
     struct AccountLoan {
         int itemId;
         std::string title;
         QDate dueDate;
         int daysRemaining; 
+        LoanStanding standing;
     };
     struct AccountHold {
         int itemId;
@@ -63,40 +132,117 @@ public:
     std::vector<AccountLoan> getAccountLoans(int patronId, const QDate& today = QDate::currentDate()) const;
     std::vector<AccountHold> getAccountHolds(int patronId) const;
 
+    // --- Due dates ---
+    // A loan becomes DueSoon DUE_SOON_DAYS before its due date and Overdue the day after it.
+    struct LoanEvent {
+        LoanStanding standing;
+        int itemId;
+        int patronId;
+        QDate dueDate;
+    };
+    struct OverdueLoan {
+        int patronId;
+        int itemId;
+        std::string title;
+        QDate dueDate;
+        int daysOverdue;
+    };
+    // Advances the due-date scheduler to today and applies the loans whose standing changed.
+    // Only loans that cross a boundary are visited; calling it again on the same day is a no-op.
+    std::vector<LoanEvent> runDueDateCheck(const QDate& today = QDate::currentDate());
+    // Overdue loans as of the last due-date check, oldest due date first.
+    std::vector<OverdueLoan> getOverdueLoans(int patronId, const QDate& today = QDate::currentDate()) const;
+    // Every patron's overdue loans, in patron id order and then oldest due date first.
+    std::vector<OverdueLoan> getAllOverdueLoans(const QDate& today = QDate::currentDate()) const;
+
     // Libraraian Operations
     bool removeItemFromCatalogue(int librarianID, int itemId);
     bool addItemToCatalogue(int librarianID, const ItemInDB& data);
-//    void removeItemByID(int itemid_);
+    // Streams records from source and inserts the valid ones in transactions of chunkSize
+    // rows through one prepared statement. Invalid or refused rows are listed in the report
+    // and skipped. Listeners get a single Reloaded once the import is done.
+    ImportReport importCatalogue(int librarianID, QIODevice& source, ImportFormat format,
+                                 int chunkSize = IMPORT_CHUNK_SIZE);
     std::shared_ptr<User> LibrarianFindPatronByName(const std::string& name) const;
 
+    // --- Reporting ---
+    // Streams matching rows to sink from a forward-only query, one row at a time, so
+    // memory use does not grow with the export. Returns the rows written, or -1 on error.
+    qint64 exportRecords(const ExportOptions& options, QIODevice& sink) const;
+    // Fines every loan overdue on assessedOn from one forward-only pass over loans in patron
+    // order, and writes them to the fines table in a single transaction. With threads > 1
+    // the pass is split into patron id ranges that are read in parallel.
+    FineReport assessFines(const QDate& assessedOn = QDate::currentDate(), int threads = 1,
+                           const FinePolicy& policy = FinePolicy());
+
+    // --- Activity log ---
+    ActivityLogStats activityLogStats() const;
+    // Blocks until the activity rows logged so far are in the database; false if that timed out.
+    bool flushActivityLog();
+
 
     // Constants
+    static constexpr const char* DEFAULT_DATABASE_PATH = "db/hinlibs.sqlite3";
     static constexpr int MAX_ACTIVE_LOANS = 3;
     static constexpr int LOAN_PERIOD_DAYS = 14;
+    static constexpr int DUE_SOON_DAYS = 2;
+    static constexpr int MAX_READ_CONNECTIONS = 8;
+    static constexpr int IMPORT_CHUNK_SIZE = 5000;
+    static constexpr int MAX_FINE_THREADS = 8;
 
 
 
 
 private:
-    QSqlDatabase db_;
+    const DatabaseProfile profile_;
+    mutable ConnectionPool pool_;                                  // per-thread connections, opened lazily even from const methods
+    QThreadPool fineScanThreads_;                                  // long-lived, so each keeps its read connection between runs
+    std::unique_ptr<ActivityLogger> activityLog_;                  // writes on its own thread; destroyed before pool_
+
+    // prepared once per thread, reused by borrowItem; held by pool_ (see ConnectionPool::attachment)
+    struct CheckoutStatements {
+        QSqlQuery checkoutItem;
+        QSqlQuery consumeHold;
+        QSqlQuery insertLoan;
+    };
+
     struct Loan {
         int itemId{};
         int patronId{};
         QDate checkout{};
         QDate due{};
+        LoanStanding standing{LoanStanding::Current};
     };
 
     // state
-    std::vector<std::shared_ptr<Item>> items_;
+    ItemStore items_;                                              // columnar catalogue with an id -> slot index
+    ItemTextIndex textIndex_;                                      // trigrams over title + creator
+    mutable std::shared_mutex cacheMutex_;                         // guards items_, holds_ and the loan state below
+    std::map<int, ItemChangeListener> itemChangeListeners_;        // listenerId -> callback
+    mutable std::mutex listenersMutex_;
+    std::mutex placeHoldMutex_;                                    // serialises placeHold
+    int nextListenerId_{1};
     std::unordered_map<int, std::shared_ptr<User>> usersById_;
     std::unordered_map<std::string, int> userIdByName_;           // case-sensitive exact match (D1)
     std::unordered_map<int, Loan> loansByItemId_;                 // itemId -> loan
-    std::unordered_map<int, std::deque<int>> holdsByItemId_;      // itemId -> FIFO patronIds
-//    std::unordered_map<int, std::vector<std::string>> log_of_user_activites;  // Track patron system activites
+    std::unordered_map<int, int> activeLoansByPatron_;            // patronId -> rows in loans + borrows in flight; no entry means 0
+    HoldQueues holds_;                                             // mirrors the holds table; authoritative for hold checks
+    DueDateScheduler dueDates_{DUE_SOON_DAYS};                     // timers over loansByItemId_ due dates
+    std::map<int, std::vector<int>> overdueItemsByPatron_;        // patronId -> items in Overdue loans
 
     // helpers
     void seed();
-    int countLoansForPatron(int patronId) const;
+    CheckoutStatements& checkoutStatements();
+    void notifyItemChanged(ItemChange change, int itemId) const;
+    bool reserveLoanSlot(int patronId);
+    void releaseLoanSlot(int patronId);
+    void logActivity(int userId, Activity activity, int itemId);
+    std::optional<FineTally> scanOverdueLoans(int firstPatronId, int lastPatronId, const QDate& assessedOn,
+                                              const FinePolicy& policy) const;
+    std::vector<LoanEvent> applyDueDateEvents(const std::vector<DueDateScheduler::Fired>& fired);
+    void forgetOverdue(const Loan& loan);
+    void appendOverdueLoans(int patronId, const std::vector<int>& itemIds, const QDate& today,
+                            std::vector<OverdueLoan>& out) const;
 
     static int daysBetween(const QDate& a, const QDate& b) { return a.daysTo(b); }
 };
@@ -0,0 +1,115 @@
+#include "Migrations.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+#include <vector>
+
+namespace hinlibs {
+
+namespace {
+
+struct Migration {
+    int version;
+    std::vector<const char*> statements;
+};
+
+// Append new migrations at the end with the next version number; never edit one that has shipped.
+const std::vector<Migration>& migrations() {
+    static const std::vector<Migration> all = {
+        { 1, {
+            // loans WHERE userid_ = ?  (account view, loan limit, return)
+            "CREATE INDEX IF NOT EXISTS idx_loans_user_item ON loans (userid_, itemid_, dueDate_)",
+            // loans WHERE itemid_ = ?  (checkout, hold placement)
+            "CREATE INDEX IF NOT EXISTS idx_loans_item_user ON loans (itemid_, userid_)",
+        } },
+        { 2, {
+            // holds WHERE itemid_ = ? ORDER BY holdid_  (queue head, queue position)
+            "CREATE INDEX IF NOT EXISTS idx_holds_item_hold ON holds (itemid_, holdid_, userid_)",
+            // holds WHERE userid_ = ?  (account view, cancel)
+            "CREATE INDEX IF NOT EXISTS idx_holds_user_item ON holds (userid_, itemid_)",
+        } },
+        { 3, {
+            // External-content FTS5 index over the searchable item columns, kept in step by triggers.
+            "CREATE VIRTUAL TABLE IF NOT EXISTS items_fts USING fts5("
+            "title_, creator_, isbn_, genre_, dewey_, "
+            "content='items', content_rowid='itemid_', tokenize='unicode61 remove_diacritics 2')",
+            "CREATE TRIGGER IF NOT EXISTS items_fts_ai AFTER INSERT ON items BEGIN "
+            "INSERT INTO items_fts (rowid, title_, creator_, isbn_, genre_, dewey_) "
+            "VALUES (new.itemid_, new.title_, new.creator_, new.isbn_, new.genre_, new.dewey_); END",
+            "CREATE TRIGGER IF NOT EXISTS items_fts_ad AFTER DELETE ON items BEGIN "
+            "INSERT INTO items_fts (items_fts, rowid, title_, creator_, isbn_, genre_, dewey_) "
+            "VALUES ('delete', old.itemid_, old.title_, old.creator_, old.isbn_, old.genre_, old.dewey_); END",
+            "CREATE TRIGGER IF NOT EXISTS items_fts_au AFTER UPDATE OF title_, creator_, isbn_, genre_, dewey_ ON items BEGIN "
+            "INSERT INTO items_fts (items_fts, rowid, title_, creator_, isbn_, genre_, dewey_) "
+            "VALUES ('delete', old.itemid_, old.title_, old.creator_, old.isbn_, old.genre_, old.dewey_); "
+            "INSERT INTO items_fts (rowid, title_, creator_, isbn_, genre_, dewey_) "
+            "VALUES (new.itemid_, new.title_, new.creator_, new.isbn_, new.genre_, new.dewey_); END",
+            "INSERT INTO items_fts (items_fts) VALUES ('rebuild')",
+        } },
+        { 4, {
+            // One row per overdue loan, updated by each fines run; rows stay after the loan is returned.
+            "CREATE TABLE IF NOT EXISTS fines ("
+            "loanid_ INTEGER PRIMARY KEY, "
+            "userid_ INTEGER NOT NULL, "
+            "itemid_ INTEGER NOT NULL, "
+            "daysOverdue_ INTEGER NOT NULL, "
+            "amountCents_ INTEGER NOT NULL CHECK (amountCents_ >= 0), "
+            "assessedOn_ TEXT NOT NULL)",
+        } },
+    };
+    return all;
+}
+
+int currentSchemaVersion(QSqlDatabase& db) {
+    QSqlQuery query(db);
+    if (!query.exec("PRAGMA user_version") || !query.next()) {
+        qDebug() << "ERROR:" << query.lastError().text();
+        return -1;
+    }
+    return query.value(0).toInt();
+}
+
+} // namespace
+
+int latestSchemaVersion() {
+    return migrations().empty() ? 0 : migrations().back().version;
+}
+
+bool runMigrations(QSqlDatabase& db) {
+    const int current = currentSchemaVersion(db);
+    if (current < 0) return false;
+
+    for (const auto& migration : migrations()) {
+        if (migration.version <= current) continue;
+
+        if (!db.transaction()) {
+            qDebug() << "ERROR:" << db.lastError().text();
+            return false;
+        }
+
+        QSqlQuery query(db);
+        bool ok = true;
+        for (const char* sql : migration.statements) {
+            if (!query.exec(sql)) {
+                qDebug() << "ERROR: migration" << migration.version << query.lastError().text();
+                ok = false;
+                break;
+            }
+        }
+
+        // user_version lives in the database header, so it commits atomically with the migration.
+        if (ok && !query.exec(QString("PRAGMA user_version = %1").arg(migration.version))) {
+            qDebug() << "ERROR:" << query.lastError().text();
+            ok = false;
+        }
+
+        if (!ok || !db.commit()) {
+            db.rollback();
+            return false;
+        }
+        qDebug() << "Applied schema migration" << migration.version;
+    }
+    return true;
+}
+
+} // namespace hinlibs
@@ -0,0 +1,14 @@
+#pragma once
+#include <QSqlDatabase>
+
+namespace hinlibs {
+
+// Brings the schema up to the latest version recorded in PRAGMA user_version.
+// Each numbered migration runs in its own transaction and is applied at most once.
+// Returns false if a migration fails; earlier migrations stay applied.
+bool runMigrations(QSqlDatabase& db);
+
+// Schema version this build expects after runMigrations().
+int latestSchemaVersion();
+
+} // namespace hinlibs
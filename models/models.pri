@@ -0,0 +1,16 @@
+# Links an application against the models static library built by models.pro.
+
+QT += core sql concurrent
+
+INCLUDEPATH += \
+    $$PWD/.. \
+    $$PWD
+
+HINLIBS_LIB_DIR = $$shadowed($$PWD)
+win32:CONFIG(release, debug|release): HINLIBS_LIB_DIR = $$HINLIBS_LIB_DIR/release
+else:win32:CONFIG(debug, debug|release): HINLIBS_LIB_DIR = $$HINLIBS_LIB_DIR/debug
+
+LIBS += -L$$HINLIBS_LIB_DIR -lhinlibs
+
+win32-g++|!win32: PRE_TARGETDEPS += $$HINLIBS_LIB_DIR/libhinlibs.a
+else: PRE_TARGETDEPS += $$HINLIBS_LIB_DIR/hinlibs.lib
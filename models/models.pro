@@ -0,0 +1,58 @@
+TEMPLATE = lib
+CONFIG += staticlib c++17
+TARGET = hinlibs
+
+QT = core sql concurrent
+
+SOURCES += \
+    User.cpp \
+    Patron.cpp \
+    Item.cpp \
+    Book.cpp \
+    Movie.cpp \
+    VideoGame.cpp \
+    Magazine.cpp \
+    LibrarySystem.cpp \
+    Migrations.cpp \
+    ItemStore.cpp \
+    HoldQueues.cpp \
+    DueDateScheduler.cpp \
+    FineAssessment.cpp \
+    ActivityLog.cpp \
+    ItemTextIndex.cpp \
+    AsyncLibrarySystem.cpp \
+    ConnectionPool.cpp \
+    DatabaseProfile.cpp \
+    DatasetGenerator.cpp \
+    CatalogueImport.cpp \
+    CatalogueExport.cpp \
+    hinlibs.cpp
+
+HEADERS += \
+    User.h \
+    Patron.h \
+    Item.h \
+    Book.h \
+    Movie.h \
+    VideoGame.h \
+    Magazine.h \
+    LibrarySystem.h \
+    Migrations.h \
+    ItemStore.h \
+    HoldQueues.h \
+    DueDateScheduler.h \
+    FineAssessment.h \
+    ActivityLog.h \
+    ItemTextIndex.h \
+    AsyncLibrarySystem.h \
+    ConnectionPool.h \
+    DatabaseProfile.h \
+    DatasetGenerator.h \
+    CatalogueImport.h \
+    CatalogueExport.h \
+    hinlibs.h \
+    itemInDB.h
+
+INCLUDEPATH += \
+    $$PWD/.. \
+    $$PWD